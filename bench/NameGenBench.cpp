@@ -0,0 +1,466 @@
+// namegen_bench: throughput, latency and allocation benchmark for every
+// GenerationStrategy.
+//
+// Profiles are synthesized from a fixed-seed word corpus at several sizes, so
+// the suite runs offline and results are comparable between runs. Each case is
+// one (profile size, strategy, variant) triple, where the variant is "plain",
+// "blend" (a second profile of the same size via loadSecondProfile) or
+// "length" (min/max length constraints). Results are written as JSON.
+
+#include "NameGenerator.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Count every heap allocation made by the process. GCC flags the free() of
+// pointers it has seen come from operator new, but both sides are ours.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+namespace {
+std::atomic<uint64_t> g_allocations{0};
+}
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size != 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Counts = std::map<std::string, uint64_t>;
+using CountTable = std::map<std::string, Counts>;
+
+struct ProfileSize {
+    const char* name;
+    size_t words;
+    size_t syllables;
+};
+
+constexpr ProfileSize kProfileSizes[] = {
+    {"small", 500, 40},
+    {"medium", 5000, 200},
+    {"large", 50000, 1000},
+};
+
+struct StrategyCase {
+    const char* name;
+    GenerationStrategy strategy;
+};
+
+constexpr StrategyCase kStrategies[] = {
+    {"legacy", GenerationStrategy::Legacy},
+    {"markov1", GenerationStrategy::Markov1},
+    {"markov2", GenerationStrategy::Markov2},
+    {"syllable", GenerationStrategy::Syllable},
+    {"component", GenerationStrategy::Component},
+    {"ngram", GenerationStrategy::NGram},
+};
+
+// Length window for the "length" variant
+constexpr size_t kMinLength = 5;
+constexpr size_t kMaxLength = 8;
+
+struct Syllable {
+    std::string onset;
+    std::string nucleus;
+    std::string coda;
+    std::string text() const { return onset + nucleus + coda; }
+};
+
+// Word corpus built from a random syllable inventory; the seed picks the
+// "language", so two seeds give two profiles worth blending
+std::vector<std::vector<Syllable>> makeCorpus(const ProfileSize& size, uint32_t seed) {
+    static const char* const kOnsets[] = {"", "b", "d", "g", "k", "l", "m", "n", "p", "r", "s", "t", "v",
+                                          "z", "th", "kr", "st", "dr", "ph", "gl", "br", "sk", "h", "f"};
+    static const char* const kNuclei[] = {"a", "e", "i", "o", "u", "y", "ae", "ai", "ou", "ei", "ia"};
+    static const char* const kCodas[] = {"", "", "", "n", "r", "s", "l", "m", "th", "x", "k", "nd"};
+
+    std::mt19937 rng(seed);
+    auto pick = [&rng](const auto& list) {
+        return std::string(list[std::uniform_int_distribution<size_t>(0, std::size(list) - 1)(rng)]);
+    };
+
+    std::vector<Syllable> inventory;
+    for (size_t i = 0; i < size.syllables; ++i) {
+        inventory.push_back({pick(kOnsets), pick(kNuclei), pick(kCodas)});
+    }
+
+    // Zipf-like syllable frequencies, as in natural name lists
+    std::vector<double> weights;
+    for (size_t i = 0; i < inventory.size(); ++i) {
+        weights.push_back(1.0 / static_cast<double>(i + 1));
+    }
+    std::discrete_distribution<size_t> syllable_dist(weights.begin(), weights.end());
+    std::uniform_int_distribution<int> length_dist(2, 4);
+
+    std::vector<std::vector<Syllable>> words;
+    for (size_t i = 0; i < size.words; ++i) {
+        std::vector<Syllable> word;
+        for (int n = length_dist(rng); n > 0; --n) {
+            word.push_back(inventory[syllable_dist(rng)]);
+        }
+        words.push_back(std::move(word));
+    }
+    return words;
+}
+
+const char* positionName(size_t index, size_t count) {
+    if (index == 0) {
+        return "start";
+    }
+    return index + 1 == count ? "end" : "middle";
+}
+
+void writeCounts(std::ostream& out, const Counts& counts) {
+    out << '{';
+    bool first = true;
+    for (const auto& [key, count] : counts) {
+        out << (first ? "" : ",") << '"' << key << "\":" << count;
+        first = false;
+    }
+    out << '}';
+}
+
+void writeTable(std::ostream& out, const CountTable& table) {
+    out << '{';
+    bool first = true;
+    for (const auto& [key, counts] : table) {
+        out << (first ? "" : ",") << '"' << key << "\":";
+        writeCounts(out, counts);
+        first = false;
+    }
+    out << '}';
+}
+
+// Analyze the corpus into the NameAnalyzer JSON profile layout
+std::string makeProfileJson(const std::vector<std::vector<Syllable>>& words) {
+    CountTable markov1, markov2, bigrams, trigrams;
+    CountTable syllables, syllable_markov1, syllable_markov2, onsets, codas_by_position;
+    Counts nuclei, codas;
+
+    for (const auto& word : words) {
+        std::string text;
+        for (const auto& syllable : word) {
+            text += syllable.text();
+        }
+
+        std::string walk = "^" + text + "$";
+        for (size_t i = 1; i < walk.size(); ++i) {
+            ++markov1[walk.substr(i - 1, 1)][walk.substr(i, 1)];
+        }
+        walk = "^^" + text + "$";
+        for (size_t i = 2; i < walk.size(); ++i) {
+            ++markov2[walk.substr(i - 2, 2)][walk.substr(i, 1)];
+        }
+
+        ++bigrams["start"][text.substr(0, 2)];
+        ++bigrams["end"][text.substr(text.size() - 2)];
+        for (size_t i = 1; i + 2 < text.size(); ++i) {
+            ++bigrams["middle"][text.substr(i, 2)];
+        }
+        if (text.size() >= 3) {
+            ++trigrams["start"][text.substr(0, 3)];
+            ++trigrams["end"][text.substr(text.size() - 3)];
+        }
+        for (size_t i = 1; i + 3 < text.size(); ++i) {
+            ++trigrams["middle"][text.substr(i, 3)];
+        }
+
+        for (size_t i = 0; i < word.size(); ++i) {
+            const char* position = positionName(i, word.size());
+            ++syllables[position][word[i].text()];
+            if (i > 0) {
+                ++syllable_markov1[word[i - 1].text()][word[i].text()];
+            }
+            if (i > 1) {
+                ++syllable_markov2[word[i - 2].text() + "|" + word[i - 1].text()][word[i].text()];
+            }
+            ++onsets[position][word[i].onset];
+            ++codas_by_position[position][word[i].coda];
+            ++nuclei[word[i].nucleus];
+            ++codas[word[i].coda];
+        }
+    }
+
+    std::ostringstream out;
+    out << R"({"config":{"markov_order":2,"syllables_enabled":true,"components_enabled":true},)";
+    out << R"("letter_analysis":{"markov_chains":{"order_1":)";
+    writeTable(out, markov1);
+    out << R"(,"order_2":)";
+    writeTable(out, markov2);
+    out << R"(},"positional_bigrams":)";
+    writeTable(out, bigrams);
+    out << R"(,"positional_trigrams":)";
+    writeTable(out, trigrams);
+    out << R"(},"syllable_analysis":{"positional_syllables":)";
+    writeTable(out, syllables);
+    out << R"(,"syllable_markov":{"order_1":)";
+    writeTable(out, syllable_markov1);
+    out << R"(,"order_2":)";
+    writeTable(out, syllable_markov2);
+    out << R"(}},"component_analysis":{"frequencies":{"nuclei":)";
+    writeCounts(out, nuclei);
+    out << R"(,"codas":)";
+    writeCounts(out, codas);
+    out << R"(},"positional_onsets":)";
+    writeTable(out, onsets);
+    out << R"(,"positional_codas":)";
+    writeTable(out, codas_by_position);
+    out << "}}";
+    return out.str();
+}
+
+struct BenchResult {
+    std::string profile;
+    std::string strategy;
+    std::string variant;
+    uint64_t names = 0;
+    double names_per_sec = 0.0;
+    double ns_per_name = 0.0;
+    double allocations_per_name = 0.0;
+    double p50_ns = 0.0;
+    double p99_ns = 0.0;
+    double mean_length = 0.0;
+};
+
+BenchResult runCase(NameGenerator& generator, uint64_t names) {
+    BenchResult result;
+    result.names = names;
+
+    // Names are appended to one reused arena, as the streaming output does,
+    // so the allocation count reflects the generators themselves
+    std::string arena;
+
+    // Warm up caches, lazily built state and the arena's capacity
+    for (uint64_t i = 0; i < std::min<uint64_t>(names / 10, 10000); ++i) {
+        arena.clear();
+        generator.generateInto(arena);
+    }
+
+    // Throughput pass: no per-call instrumentation
+    uint64_t total_length = 0;
+    uint64_t allocations_before = g_allocations.load(std::memory_order_relaxed);
+    auto start = Clock::now();
+    for (uint64_t i = 0; i < names; ++i) {
+        arena.clear();
+        total_length += generator.generateInto(arena).size();
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    uint64_t allocations = g_allocations.load(std::memory_order_relaxed) - allocations_before;
+
+    result.ns_per_name = elapsed / static_cast<double>(names);
+    result.names_per_sec = 1e9 / result.ns_per_name;
+    result.allocations_per_name = static_cast<double>(allocations) / static_cast<double>(names);
+    result.mean_length = static_cast<double>(total_length) / static_cast<double>(names);
+
+    // Latency pass: every call timed individually (includes clock overhead)
+    std::vector<double> latencies(names);
+    for (uint64_t i = 0; i < names; ++i) {
+        arena.clear();
+        auto call_start = Clock::now();
+        total_length += generator.generateInto(arena).size();
+        latencies[i] = std::chrono::duration<double, std::nano>(Clock::now() - call_start).count();
+    }
+    auto percentile = [&latencies](double p) {
+        size_t index = static_cast<size_t>(p * static_cast<double>(latencies.size() - 1));
+        std::nth_element(latencies.begin(), latencies.begin() + static_cast<std::ptrdiff_t>(index), latencies.end());
+        return latencies[index];
+    };
+    result.p50_ns = percentile(0.50);
+    result.p99_ns = percentile(0.99);
+
+    // Keep the generated names observable so the loops aren't optimized out
+    if (total_length == 0) {
+        std::cerr << "Warning: benchmark generated only empty names\n";
+    }
+    return result;
+}
+
+void writeResults(std::ostream& out, RngKind rng, uint64_t names, const std::vector<BenchResult>& results) {
+    out << "{\n  \"benchmark\": \"namegen\",\n  \"rng\": \"" << Rng::kindName(rng) << "\",\n  \"names_per_case\": " << names
+        << ",\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        out << (i == 0 ? "\n" : ",\n")
+            << "    {\"profile\": \"" << r.profile << "\", \"strategy\": \"" << r.strategy
+            << "\", \"variant\": \"" << r.variant << "\", \"names\": " << r.names
+            << ", \"names_per_sec\": " << r.names_per_sec << ", \"ns_per_name\": " << r.ns_per_name
+            << ", \"allocations_per_name\": " << r.allocations_per_name << ", \"p50_ns\": " << r.p50_ns
+            << ", \"p99_ns\": " << r.p99_ns << ", \"mean_length\": " << r.mean_length << '}';
+    }
+    out << "\n  ]\n}\n";
+}
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [options]\n"
+              << "\n"
+              << "Options:\n"
+              << "  --names <n>             Names generated per case (default: 100000)\n"
+              << "  --sizes <list>          Comma-separated profile sizes (default: small,medium,large)\n"
+              << "  --strategy <name>       Only run this strategy\n"
+              << "  --rng <engine>          Random engine (default: xoshiro256pp)\n"
+              << "  -o, --output <file>     Write JSON results to a file instead of stdout\n"
+              << "  --help, -h              Show this help message\n";
+}
+
+// Scoped synthetic profile file in the temp directory
+class TempProfile {
+public:
+    TempProfile(const std::string& label, const std::string& json)
+        : path_(std::filesystem::temp_directory_path() /
+                ("namegen_bench_" + std::to_string(std::random_device{}()) + "_" + label + ".json")) {
+        std::ofstream file(path_);
+        if (!file.is_open() || !(file << json)) {
+            throw std::runtime_error("Failed to write synthetic profile: " + path_.string());
+        }
+    }
+    ~TempProfile() {
+        std::error_code ignored;
+        std::filesystem::remove(path_, ignored);
+    }
+    TempProfile(const TempProfile&) = delete;
+    TempProfile& operator=(const TempProfile&) = delete;
+
+    std::string path() const { return path_.string(); }
+
+private:
+    std::filesystem::path path_;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    uint64_t names = 100000;
+    std::vector<std::string> sizes = {"small", "medium", "large"};
+    std::string only_strategy;
+    std::string output_path;
+    RngKind rng_kind = RngKind::Xoshiro256pp;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (arg == "--names" && i + 1 < argc) {
+            try {
+                names = std::stoull(argv[++i]);
+            } catch (const std::exception&) {
+                std::cerr << "Error: Invalid --names value\n";
+                return 1;
+            }
+            if (names == 0) {
+                std::cerr << "Error: --names must be positive\n";
+                return 1;
+            }
+        } else if (arg == "--sizes" && i + 1 < argc) {
+            sizes.clear();
+            std::stringstream list(argv[++i]);
+            for (std::string size; std::getline(list, size, ',');) {
+                sizes.push_back(size);
+            }
+        } else if (arg == "--strategy" && i + 1 < argc) {
+            only_strategy = argv[++i];
+        } else if (arg == "--rng" && i + 1 < argc) {
+            if (!Rng::parseKind(argv[++i], rng_kind)) {
+                std::cerr << "Error: Unknown RNG '" << argv[i] << "'\n";
+                return 1;
+            }
+        } else if ((arg == "-o" || arg == "--output") && i + 1 < argc) {
+            output_path = argv[++i];
+        } else {
+            std::cerr << "Error: Unknown option '" << arg << "'\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<BenchResult> results;
+    try {
+        for (const std::string& size_name : sizes) {
+            auto size = std::find_if(std::begin(kProfileSizes), std::end(kProfileSizes),
+                                     [&size_name](const ProfileSize& s) { return size_name == s.name; });
+            if (size == std::end(kProfileSizes)) {
+                std::cerr << "Error: Unknown profile size '" << size_name << "'\n";
+                return 1;
+            }
+
+            TempProfile primary(size_name + "_a", makeProfileJson(makeCorpus(*size, 1)));
+            TempProfile secondary(size_name + "_b", makeProfileJson(makeCorpus(*size, 2)));
+
+            for (const StrategyCase& strategy : kStrategies) {
+                if (!only_strategy.empty() && only_strategy != strategy.name) {
+                    continue;
+                }
+
+                for (const char* variant : {"plain", "blend", "length"}) {
+                    std::string variant_name = variant;
+
+                    // Legacy patterns don't use profiles and can't blend
+                    if (strategy.strategy == GenerationStrategy::Legacy && variant_name == "blend") {
+                        continue;
+                    }
+
+                    NameGenerator generator;
+                    generator.seed(42);
+                    generator.setRng(rng_kind);
+                    generator.loadProfile(primary.path());
+                    if (variant_name == "blend") {
+                        generator.loadSecondProfile(secondary.path());
+                    }
+                    generator.setStrategy(strategy.strategy);
+                    if (variant_name == "length") {
+                        generator.setMinLength(kMinLength);
+                        generator.setMaxLength(kMaxLength);
+                    }
+
+                    std::cerr << "Running " << size_name << '/' << strategy.name << '/' << variant_name << "...\n";
+                    BenchResult result = runCase(generator, names);
+                    result.profile = size_name;
+                    result.strategy = strategy.name;
+                    result.variant = variant_name;
+                    results.push_back(result);
+                }
+            }
+        }
+
+        if (output_path.empty()) {
+            writeResults(std::cout, rng_kind, names, results);
+        } else {
+            std::ofstream file(output_path);
+            if (!file.is_open()) {
+                throw std::runtime_error("Failed to open output file: " + output_path);
+            }
+            writeResults(file, rng_kind, names, results);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,56 @@
+#ifndef ALIAS_TABLE_HPP
+#define ALIAS_TABLE_HPP
+
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "Rng.hpp"
+
+// Vose alias table for O(1) weighted sampling.
+//
+// Built once from integer weights; every sample then costs a single random
+// draw, one division and one comparison, regardless of how many items there
+// are. All arithmetic is done in integers, so the sampled distribution matches
+// the weights exactly.
+//
+// Layout: bucket i is picked uniformly, then a second uniform value in
+// [0, total) decides between i itself (below threshold[i]) and alias[i].
+class AliasTable {
+public:
+    AliasTable() = default;
+
+    // Build from weights (zero weights are never sampled)
+    explicit AliasTable(std::span<const uint64_t> weights);
+
+    // Build a table in caller-provided storage (used by flat/compiled tables).
+    // threshold and alias must have weights.size() entries.
+    // Returns the total weight (0 = nothing can be sampled).
+    static uint64_t build(std::span<const uint64_t> weights,
+                          std::span<uint64_t> threshold,
+                          std::span<uint32_t> alias);
+
+    // Resolve a uniform value in [0, size * total) to an item index
+    static uint32_t pick(uint64_t value, uint64_t total,
+                         const uint64_t* threshold, const uint32_t* alias) {
+        uint64_t bucket = value / total;
+        uint64_t coin = value % total;
+        return coin < threshold[bucket] ? static_cast<uint32_t>(bucket) : alias[bucket];
+    }
+
+    // Sample an index (table must not be empty)
+    template <typename URBG>
+    uint32_t sample(URBG& rng) const {
+        return pick(boundedRandom(rng, threshold_.size() * total_), total_, threshold_.data(), alias_.data());
+    }
+
+    bool empty() const { return total_ == 0; }
+    size_t size() const { return threshold_.size(); }
+    uint64_t totalWeight() const { return total_; }
+
+private:
+    std::vector<uint64_t> threshold_;
+    std::vector<uint32_t> alias_;
+    uint64_t total_ = 0;
+};
+
+#endif // ALIAS_TABLE_HPP
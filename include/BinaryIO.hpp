@@ -0,0 +1,103 @@
+#ifndef BINARY_IO_HPP
+#define BINARY_IO_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Helpers for the compiled profile image (.ngp).
+//
+// Values are written in native byte order; arrays start on an 8-byte
+// boundary so a reader over an mmap'd image can use them in place.
+
+class BinaryWriter {
+public:
+    template <typename T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        buffer_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    // Aligned array, usable in place by BinaryReader::array()
+    template <typename T>
+    void putArray(std::span<const T> values) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        align();
+        buffer_.append(reinterpret_cast<const char*>(values.data()), values.size_bytes());
+    }
+
+    // Length-prefixed string
+    void putString(std::string_view str) {
+        put(static_cast<uint32_t>(str.size()));
+        buffer_.append(str);
+    }
+
+    void align() {
+        buffer_.append((8 - buffer_.size() % 8) % 8, '\0');
+    }
+
+    const std::string& data() const { return buffer_; }
+
+private:
+    std::string buffer_;
+};
+
+class BinaryReader {
+public:
+    BinaryReader(const char* data, size_t size) : data_(data), size_(size) {}
+
+    template <typename T>
+    T get() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        require(sizeof(T));
+        T value;
+        std::memcpy(&value, data_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return value;
+    }
+
+    // View of an aligned array written by BinaryWriter::putArray()
+    template <typename T>
+    std::span<const T> array(size_t count) {
+        align();
+        if (count > (size_ - pos_) / sizeof(T)) {
+            throw std::runtime_error("Corrupt profile image: array out of bounds");
+        }
+        const T* first = reinterpret_cast<const T*>(data_ + pos_);
+        pos_ += count * sizeof(T);
+        return {first, count};
+    }
+
+    std::string_view getString() {
+        uint32_t length = get<uint32_t>();
+        require(length);
+        std::string_view str(data_ + pos_, length);
+        pos_ += length;
+        return str;
+    }
+
+    void align() {
+        size_t padded = (pos_ + 7) & ~size_t{7};
+        if (padded > size_) {
+            throw std::runtime_error("Corrupt profile image: truncated");
+        }
+        pos_ = padded;
+    }
+
+private:
+    void require(size_t bytes) const {
+        if (bytes > size_ - pos_) {
+            throw std::runtime_error("Corrupt profile image: truncated");
+        }
+    }
+
+    const char* data_;
+    size_t size_;
+    size_t pos_ = 0;
+};
+
+#endif // BINARY_IO_HPP
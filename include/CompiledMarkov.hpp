@@ -0,0 +1,149 @@
+#ifndef COMPILED_MARKOV_HPP
+#define COMPILED_MARKOV_HPP
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "AliasTable.hpp"
+#include "BinaryIO.hpp"
+
+// Letter-level Markov chain compiled to dense integer states.
+//
+// Every byte seen in the profile gets a small symbol code; code 0 is the name
+// boundary, standing for both the '^' start padding in contexts and the '$'
+// end marker in transitions. A context of `order` symbols becomes the state
+// id c0 * S^(order-1) + ... + c(order-1), so advancing the chain is integer
+// arithmetic instead of building and looking up context strings.
+//
+// Outgoing transitions are stored contiguously per state (CSR layout), each
+// state with its own alias table over its slice. The arrays are either owned
+// (compiled from a profile) or point straight into a mapped .ngp image.
+class CompiledMarkov {
+public:
+    // Symbol code for the start/end boundary
+    static constexpr uint8_t kBoundary = 0;
+
+    // Returned by sample() when the state has no outgoing transitions
+    static constexpr int kDeadEnd = -1;
+
+    // Returned by stateFor() when the context contains an unknown symbol
+    static constexpr uint32_t kInvalidState = UINT32_MAX;
+
+    // One context -> next transition as read from the profile
+    struct Transition {
+        std::string_view context;  // `order` bytes, '^' for start padding
+        std::string_view next;     // one byte, or "$" for end of name
+        uint64_t weight;
+    };
+
+    CompiledMarkov() = default;
+
+    // Compile transitions of the given order. Transitions whose context or
+    // next symbol aren't single bytes are skipped.
+    static CompiledMarkov compile(int order, const std::vector<Transition>& transitions);
+
+    // Weighted mixture of chains of one order, compiled into a single table
+    // (so sampling costs the same as any chain). A context's next-symbol
+    // distribution is the weight-averaged distribution of the components
+    // that have seen that context. Empty components are ignored.
+    static CompiledMarkov mix(const std::vector<std::pair<const CompiledMarkov*, double>>& components);
+
+    // Serialize into a profile image
+    void write(BinaryWriter& out) const;
+
+    // View tables stored in a profile image without copying; owner keeps the
+    // underlying memory alive for as long as the view exists
+    static CompiledMarkov view(BinaryReader& in, std::shared_ptr<const void> owner);
+
+    bool empty() const { return transition_count_ == 0; }
+    int order() const { return order_; }
+    uint32_t symbolCount() const { return static_cast<uint32_t>(symbols_.size()); }
+    uint32_t stateCount() const { return state_count_; }
+
+    // Bytes of table data (owned or mapped)
+    size_t memoryUsage() const {
+        return symbols_.size_bytes() + codes_.size_bytes() + known_.size_bytes() +
+               offsets_.size_bytes() + totals_.size_bytes() + next_.size_bytes() +
+               weights_.size_bytes() + threshold_.size_bytes() + alias_.size_bytes();
+    }
+
+    // State for an all-boundary context ("^" / "^^")
+    uint32_t startState() const { return 0; }
+
+    // State for the last `order` characters of text (padded with the start
+    // boundary when text is shorter). Used when switching between profiles.
+    uint32_t stateFor(std::string_view text) const;
+
+    // Byte for a symbol code
+    char symbol(int code) const { return symbols_[code]; }
+
+    // Follow a transition to the next state
+    uint32_t advance(uint32_t state, int code) const {
+        return static_cast<uint32_t>((static_cast<uint64_t>(state) * symbols_.size() + code) % state_count_);
+    }
+
+    // Outgoing transitions of a state are the edges [edgeBegin, edgeEnd)
+    uint32_t edgeBegin(uint32_t state) const { return offsets_[state]; }
+    uint32_t edgeEnd(uint32_t state) const { return offsets_[state + 1]; }
+    int edgeSymbol(uint32_t edge) const { return next_[edge]; }
+    uint64_t edgeWeight(uint32_t edge) const { return weights_[edge]; }
+    uint64_t stateWeight(uint32_t state) const { return totals_[state]; }
+
+    // Draw the next symbol code from a state: kBoundary ends the name,
+    // kDeadEnd means the state was never seen in the corpus
+    template <typename URBG>
+    int sample(uint32_t state, URBG& rng) const {
+        uint32_t begin = offsets_[state];
+        uint32_t count = offsets_[state + 1] - begin;
+        uint64_t total = totals_[state];
+        if (total == 0) {
+            return kDeadEnd;
+        }
+        uint32_t local = AliasTable::pick(boundedRandom(rng, count * total), total, &threshold_[begin], &alias_[begin]);
+        return next_[begin + local];
+    }
+
+private:
+    // Owned arrays for chains compiled in memory
+    struct Storage {
+        std::vector<char> symbols;
+        std::array<uint8_t, 256> codes{};
+        std::array<uint8_t, 256> known{};
+        std::vector<uint32_t> offsets;
+        std::vector<uint64_t> totals;
+        std::vector<uint8_t> next;
+        std::vector<uint64_t> weights;
+        std::vector<uint64_t> threshold;
+        std::vector<uint32_t> alias;
+    };
+
+    void attach(const Storage& storage);
+
+    int order_ = 0;
+    uint32_t state_count_ = 0;
+    uint32_t transition_count_ = 0;
+
+    // Keeps the arrays below alive (owned Storage or a mapped image)
+    std::shared_ptr<const void> owner_;
+
+    // Symbol code <-> byte
+    std::span<const char> symbols_;
+    std::span<const uint8_t> codes_;
+    std::span<const uint8_t> known_;
+
+    // CSR transitions: state s owns [offsets_[s], offsets_[s + 1])
+    std::span<const uint32_t> offsets_;
+    std::span<const uint64_t> totals_;
+    std::span<const uint8_t> next_;
+    std::span<const uint64_t> weights_;
+    std::span<const uint64_t> threshold_;
+    std::span<const uint32_t> alias_;
+};
+
+#endif // COMPILED_MARKOV_HPP
@@ -0,0 +1,87 @@
+#ifndef EXCLUSION_TRIE_HPP
+#define EXCLUSION_TRIE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Blocklist of names that must never be generated, stored as a double-array
+// trie (ASCII case-insensitive).
+//
+// A lookup follows one array transition per character, so checking a
+// candidate costs O(length) no matter how many entries there are. The two
+// int32 arrays are flat, so a compiled list (.ngx, see save()) is mmap'd and
+// used in place, like a compiled profile.
+//
+// Generators can also walk the trie alongside a name as it is built (root(),
+// step(), isWord()) and refuse to end a name on a blocked word, instead of
+// discarding finished names.
+class ExclusionTrie {
+public:
+    // Returned by step() once the text has left the trie
+    static constexpr int32_t kNoNode = -1;
+
+    ExclusionTrie() = default;
+
+    // Build from a list of words (duplicates and empty entries are ignored)
+    static ExclusionTrie build(std::vector<std::string> words);
+
+    // Load a word list (one per line) or a compiled .ngx image
+    static ExclusionTrie load(const std::string& path);
+
+    // Write a compiled image for fast loading
+    void save(const std::string& path) const;
+
+    // True if the name is on the list
+    bool contains(std::string_view name) const;
+
+    // Incremental walk: start at root(), feed characters with step()
+    int32_t root() const { return base_.empty() ? kNoNode : 0; }
+    int32_t step(int32_t node, char c) const {
+        if (node == kNoNode) {
+            return kNoNode;
+        }
+        return child(node, labelFor(c));
+    }
+
+    // True if the text walked so far is a listed word
+    bool isWord(int32_t node) const {
+        return node != kNoNode && child(node, kEndLabel) != kNoNode;
+    }
+
+    bool empty() const { return word_count_ == 0; }
+    uint64_t wordCount() const { return word_count_; }
+
+private:
+    // Label 0 marks the end of a word; bytes use label byte + 1
+    static constexpr int32_t kEndLabel = 0;
+    static constexpr uint32_t kImageVersion = 1;
+
+    static int32_t labelFor(char c) {
+        unsigned char b = static_cast<unsigned char>(c);
+        if (b >= 'A' && b <= 'Z') {
+            b = static_cast<unsigned char>(b - 'A' + 'a');
+        }
+        return static_cast<int32_t>(b) + 1;
+    }
+
+    int32_t child(int32_t node, int32_t label) const {
+        int64_t slot = static_cast<int64_t>(base_[node]) + label;
+        if (slot < 0 || slot >= static_cast<int64_t>(check_.size()) || check_[slot] != node) {
+            return kNoNode;
+        }
+        return static_cast<int32_t>(slot);
+    }
+
+    uint64_t word_count_ = 0;
+
+    // Keeps base_/check_ alive (owned vectors or a mapped image)
+    std::shared_ptr<const void> owner_;
+    std::span<const int32_t> base_;
+    std::span<const int32_t> check_;
+};
+
+#endif // EXCLUSION_TRIE_HPP
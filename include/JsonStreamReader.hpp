@@ -0,0 +1,70 @@
+#ifndef JSON_STREAM_READER_HPP
+#define JSON_STREAM_READER_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Pull parser that reads a JSON file through a fixed-size buffer.
+//
+// Nothing is kept besides the buffer and the current key or string, so a
+// caller can turn values into its own tables as they are read, without a
+// document tree or a copy of the whole file. Members the caller doesn't
+// want are passed over with skipValue().
+//
+// Errors (malformed JSON, I/O failures) throw std::runtime_error with the
+// line number.
+class JsonStreamReader {
+public:
+    static constexpr size_t kDefaultBufferSize = 64 << 10;
+
+    explicit JsonStreamReader(const std::string& path, size_t buffer_size = kDefaultBufferSize);
+    ~JsonStreamReader();
+
+    JsonStreamReader(const JsonStreamReader&) = delete;
+    JsonStreamReader& operator=(const JsonStreamReader&) = delete;
+
+    // First character of the next value ('{', '[', '"', 't', 'f', 'n', or
+    // a digit or '-'), without consuming it; 0 at the end of the input
+    char peek();
+
+    // Consume '{' if the next value is an object
+    bool beginObject();
+
+    // Inside an object: read the next member's key and the ':' after it, or
+    // consume the closing '}' and return false
+    bool nextMember(std::string& key);
+
+    // Read the next value if it has the given type; otherwise leave it
+    // unread and return false
+    bool readNumber(double& value);
+    bool readBool(bool& value);
+    bool readString(std::string& value);
+
+    // Consume the next value, whatever it is (including nested containers)
+    void skipValue();
+
+    // Throw unless only whitespace is left
+    void expectEnd();
+
+private:
+    bool fill();
+    int next();  // Next raw byte, or -1 at end of input
+    void skipWhitespace();
+    void expect(char c);
+    void expectWord(const char* word);
+    void readStringBody(std::string& out);  // After the opening quote
+    unsigned readHex4();
+    [[noreturn]] void fail(const std::string& message) const;
+
+    std::FILE* file_;
+    std::vector<char> buffer_;
+    size_t position_ = 0;
+    size_t size_ = 0;
+    size_t line_ = 1;
+    std::vector<bool> objects_;  // Open objects, innermost last: true once a member was read
+    std::string scratch_;
+};
+
+#endif // JSON_STREAM_READER_HPP
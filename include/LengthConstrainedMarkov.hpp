@@ -0,0 +1,72 @@
+#ifndef LENGTH_CONSTRAINED_MARKOV_HPP
+#define LENGTH_CONSTRAINED_MARKOV_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "CompiledMarkov.hpp"
+
+// Samples names from a compiled Markov chain conditioned on their length
+// falling inside [min_length, max_length].
+//
+// For every state and current length, a backward pass precomputes the
+// probability that the walk can still end inside the window. Each step then
+// samples transitions in proportion to (transition probability x that mass),
+// so only continuations that can finish validly are ever picked and every
+// walk produces a valid name in one pass, with exactly the distribution that
+// rejection sampling would give.
+class LengthConstrainedMarkov {
+public:
+    // cap is the hard length limit the generator applies to Markov walks;
+    // max_length == 0 means no upper bound besides cap
+    LengthConstrainedMarkov(const CompiledMarkov& chain, size_t min_length, size_t max_length, size_t cap);
+
+    // False when no name of this chain fits the window
+    bool feasible() const { return feasible_; }
+
+    const CompiledMarkov& chain() const { return chain_; }
+
+    // Next symbol code for a walk in `state` that has emitted `length`
+    // symbols; CompiledMarkov::kBoundary ends the name
+    template <typename URBG>
+    int sample(uint32_t state, size_t length, URBG& rng) const {
+        if (length >= rows_) {
+            return CompiledMarkov::kBoundary;
+        }
+
+        uint32_t begin = chain_.edgeBegin(state);
+        uint32_t end = chain_.edgeEnd(state);
+        if (begin == end) {
+            return CompiledMarkov::kBoundary;
+        }
+
+        // Binary search the cumulative valid mass of this state's edges
+        const double* first = &cumulative_[length * edge_count_ + begin];
+        const double* last = &cumulative_[length * edge_count_ + end];
+        if (!(last[-1] > 0.0)) {
+            return CompiledMarkov::kBoundary;
+        }
+        const double* pick = std::upper_bound(first, last, uniformUnit(rng) * last[-1]);
+
+        // Rounding can land past the end; step back to an edge with mass
+        if (pick == last) {
+            --pick;
+        }
+        while (pick > first && *pick == pick[-1]) {
+            --pick;
+        }
+        return chain_.edgeSymbol(begin + static_cast<uint32_t>(pick - first));
+    }
+
+private:
+    CompiledMarkov chain_;
+    size_t rows_;        // Lengths with a sampling decision; at rows_ the walk stops
+    size_t edge_count_;
+    bool feasible_ = false;
+
+    // cumulative_[length * edge_count_ + edge]: running sum over the state's
+    // edges of P(edge) * P(valid finish after taking it)
+    std::vector<double> cumulative_;
+};
+
+#endif // LENGTH_CONSTRAINED_MARKOV_HPP
@@ -0,0 +1,40 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Read-only view of a whole file.
+//
+// On POSIX systems the file is mmap'd, so pages are shared with the OS page
+// cache and only touched pages are ever read. Elsewhere the file is read into
+// an 8-byte aligned buffer. Either way data() is at least 8-byte aligned.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Replace the file at path with bytes. They are written to a temporary
+    // file in the same directory that is then renamed over path, so anyone
+    // with the old file mapped keeps reading the old contents. `what` names
+    // the file in error messages.
+    static void writeAtomically(const std::string& path, std::string_view bytes, const std::string& what);
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+
+    // Fallback storage when mmap isn't available
+    std::vector<unsigned long long> buffer_;
+};
+
+#endif // MAPPED_FILE_HPP
@@ -0,0 +1,156 @@
+#ifndef MARKOV_BATCH_SAMPLER_HPP
+#define MARKOV_BATCH_SAMPLER_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "CompiledMarkov.hpp"
+#include "Rng.hpp"
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Throughput kernel that walks a block of Markov names in lockstep.
+//
+// The chain is expanded into dense rows: for every state, the cumulative
+// weight of each symbol code (padded to a multiple of 8, so a row search is
+// a fixed-width compare-and-count the compiler vectorizes, or AVX2 when
+// enabled). Each step draws one random word per lane in bulk, samples every
+// lane, then builds a bitmask of lanes that hit the end marker or the length
+// cap. Finished lanes are emitted and refilled with a fresh walk; once no
+// more names are needed they are compacted out.
+//
+// Names follow the same distribution as CompiledMarkov::sample walks, but
+// the random draws are consumed in a different order, so a given seed gives
+// different names than the one-at-a-time generator.
+class MarkovBatchSampler {
+public:
+    static constexpr size_t kLanes = 64;
+    static constexpr size_t kMaxLaneLength = 32;
+
+    // max_length is the hard cap on a walk (at most kMaxLaneLength)
+    MarkovBatchSampler(const CompiledMarkov& chain, size_t max_length);
+
+    // False when the chain is empty, its dense rows would be too large, or a
+    // state's total weight doesn't fit the 32-bit sampler; use the regular
+    // walk then
+    bool feasible() const { return feasible_; }
+
+    // Generate count names, calling sink(std::string_view) for each
+    template <typename Sink>
+    void generate(uint64_t count, Rng& rng, Sink&& sink) const {
+        uint32_t state[kLanes];
+        uint32_t length[kLanes];
+        uint32_t symbol[kLanes];
+        uint64_t random[kLanes];
+        char text[kLanes][kMaxLaneLength];
+
+        uint64_t started = count < kLanes ? count : kLanes;
+        size_t active = static_cast<size_t>(started);
+        for (size_t lane = 0; lane < active; ++lane) {
+            state[lane] = 0;
+            length[lane] = 0;
+        }
+
+        while (active > 0) {
+            for (size_t lane = 0; lane < active; ++lane) {
+                random[lane] = rng();
+            }
+            for (size_t lane = 0; lane < active; ++lane) {
+                symbol[lane] = sampleSymbol(state[lane], random[lane], rng);
+            }
+
+            // Append and advance; the boundary symbol writes past the name
+            // harmlessly and leaves the length unchanged
+            uint64_t finished = 0;
+            for (size_t lane = 0; lane < active; ++lane) {
+                uint32_t code = symbol[lane];
+                text[lane][length[lane]] = symbols_[code];
+                length[lane] += code != 0;
+                state[lane] = next_base_[state[lane]] + code;
+                finished |= static_cast<uint64_t>((code == 0) | (length[lane] >= max_length_)) << lane;
+            }
+
+            // Retire from the highest lane down, so the lane moved into a
+            // retired slot has already been checked this step
+            while (finished != 0) {
+                size_t lane = 63 - static_cast<size_t>(std::countl_zero(finished));
+                finished &= ~(uint64_t{1} << lane);
+
+                char* name = text[lane];
+                if (length[lane] > 0 && name[0] >= 'a' && name[0] <= 'z') {
+                    name[0] = static_cast<char>(name[0] - 'a' + 'A');
+                }
+                sink(std::string_view(name, length[lane]));
+
+                if (started < count) {
+                    ++started;
+                    state[lane] = 0;
+                    length[lane] = 0;
+                } else {
+                    --active;
+                    state[lane] = state[active];
+                    length[lane] = length[active];
+                    std::copy(text[active], text[active] + length[active], text[lane]);
+                }
+            }
+        }
+    }
+
+private:
+    // Symbol code for a lane: Lemire's bounded draw over the state's total
+    // (32-bit, with rejection), then count the cumulative weights <= value
+    uint32_t sampleSymbol(uint32_t state, uint64_t random, Rng& rng) const {
+        uint32_t total = totals_[state];
+        if (total == 0) {
+            return 0;  // Dead end: the name stops here
+        }
+        uint64_t product = (random >> 32) * total;
+        uint32_t low = static_cast<uint32_t>(product);
+        if (low < total) {
+            uint32_t threshold = (0u - total) % total;
+            while (low < threshold) {
+                product = (rng() >> 32) * total;
+                low = static_cast<uint32_t>(product);
+            }
+        }
+        return countAtOrBelow(&cumulative_[static_cast<size_t>(state) * stride_],
+                              static_cast<uint32_t>(product >> 32));
+    }
+
+    uint32_t countAtOrBelow(const uint32_t* row, uint32_t value) const {
+#if defined(__AVX2__)
+        // Unsigned compare via the sign-flip trick: row <= value  <=>  !(row > value)
+        const __m256i flip = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+        const __m256i limit = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(value)), flip);
+        uint32_t count = 0;
+        for (uint32_t k = 0; k < stride_; k += 8) {
+            __m256i cumulative = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + k));
+            __m256i above = _mm256_cmpgt_epi32(_mm256_xor_si256(cumulative, flip), limit);
+            count += 8 - static_cast<uint32_t>(std::popcount(
+                static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(above)))));
+        }
+        return count;
+#else
+        // Branch-free count; the fixed stride lets the compiler vectorize it
+        uint32_t count = 0;
+        for (uint32_t k = 0; k < stride_; ++k) {
+            count += row[k] <= value;
+        }
+        return count;
+#endif
+    }
+
+    bool feasible_ = false;
+    uint32_t max_length_;
+    uint32_t stride_ = 0;               // Row width: symbol count rounded up to 8
+    std::vector<char> symbols_;         // Byte per symbol code
+    std::vector<uint32_t> totals_;      // Total weight per state
+    std::vector<uint32_t> next_base_;   // Next state is next_base_[state] + code
+    std::vector<uint32_t> cumulative_;  // states x stride_, padded with UINT32_MAX
+};
+
+#endif // MARKOV_BATCH_SAMPLER_HPP
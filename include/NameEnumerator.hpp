@@ -0,0 +1,137 @@
+#ifndef NAME_ENUMERATOR_HPP
+#define NAME_ENUMERATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "NameGenerator.hpp"
+#include "ProfileData.hpp"
+
+// Lists the names of a profile in descending order of probability, for the
+// markov1, markov2 and syllable strategies.
+//
+// Best-first search over the walks the generator can take. Every partial
+// name is a node in an arena holding only its probability, its chain state
+// and a link to its parent, so names are spelled out only when they are
+// emitted. The frontier holds (parent, rank) pairs: the rank-th most likely
+// step out of a node. Taking an entry pushes just its next sibling and the
+// first step of the new node, so the frontier grows by at most one entry per
+// step instead of by the branching factor.
+//
+// For Markov chains, steps are ranked by (step probability x the best
+// probability of finishing inside the length bounds afterwards), from a
+// backward pass over (length, state). Every entry's priority is then exactly
+// the probability of the best name below it, so the search never wanders
+// into branches that can't finish, and names come out in exact order.
+// Syllable walks are at most 1 + NameGenerator::kMaxExtraSyllables long
+// and are searched by prefix probability.
+//
+// Memory stays within the budget: when it is reached, arena nodes no
+// longer reachable from the frontier are compacted away, and if that isn't
+// enough the least likely half of the frontier is dropped. Everything
+// listed is still exact, but the listing stops at the probability of the
+// best entry dropped (see truncated()).
+//
+// Probabilities are those of one unbounded generator walk producing the
+// name; divide by ProfileAnalysis::in_bounds for the share among names
+// generated with the bounds. A syllable name spelled by several syllable
+// splits is listed once, at the probability of its likeliest split.
+class NameEnumerator {
+public:
+    static constexpr size_t kDefaultMemoryBudget = size_t(256) << 20;
+
+    // The profile must outlive the enumerator. Throws std::runtime_error
+    // for other strategies or empty tables.
+    NameEnumerator(const ProfileData& profile, GenerationStrategy strategy, size_t min_length = 0,
+                   size_t max_length = 0, size_t memory_budget = kDefaultMemoryBudget);
+
+    // Strategy searched (syllable falls back to markov2 like the generator)
+    GenerationStrategy strategy() const { return strategy_; }
+
+    // Next most likely name; false once every name was listed, or the
+    // search was cut short by the memory budget
+    bool next(std::string& name, double& probability);
+
+    // True if the budget ended the listing early; every name more likely
+    // than cutoff() was listed
+    bool truncated() const { return truncated_; }
+    double cutoff() const { return cutoff_; }
+
+    // Bytes held by the search (arena, frontier and listed syllable names)
+    size_t memoryUsage() const;
+
+private:
+    static constexpr uint32_t kNoParent = UINT32_MAX;
+
+    // A partial name
+    struct Node {
+        double probability;
+        uint32_t parent;
+        uint32_t state;   // Markov state, or the last syllable's graph node
+        uint16_t length;  // Characters so far
+        uint16_t depth;   // Syllables so far
+    };
+
+    // The rank-th step out of arena_[parent]; priority is the best
+    // probability of a name reached through it. Ties go to the older node
+    // (compaction keeps arena order), so the listing doesn't depend on the
+    // budget.
+    struct Entry {
+        double priority;
+        uint32_t parent;
+        uint32_t rank;
+
+        bool operator<(const Entry& other) const {
+            if (priority != other.priority) {
+                return priority < other.priority;
+            }
+            return parent != other.parent ? parent > other.parent : rank > other.rank;
+        }
+    };
+
+    // One step out of a node
+    struct Step {
+        double priority;  // Relative to the node's probability
+        double factor;    // Probability of taking the step
+        bool complete;    // The name ends here
+        uint32_t state;   // Child state and length (when not complete)
+        uint32_t length;
+    };
+
+    bool step(const Node& node, uint32_t rank, Step& out) const;
+    bool stepMarkov(const Node& node, uint32_t rank, Step& out) const;
+    bool stepSyllable(const Node& node, uint32_t rank, Step& out) const;
+    bool fits(size_t length) const { return length >= min_length_ && (max_length_ == 0 || length <= max_length_); }
+
+    void push(uint32_t parent, uint32_t rank);
+    void spell(uint32_t node, std::string& name);
+    void enforceBudget();
+    void collect();
+
+    const ProfileData& profile_;
+    GenerationStrategy strategy_;
+    size_t min_length_;
+    size_t max_length_;
+    size_t memory_budget_;
+
+    // Markov: chain, best valid completion per (length, state), and each
+    // state's edges per length, most promising first
+    const CompiledMarkov* chain_ = nullptr;
+    std::vector<double> best_;
+    std::vector<uint8_t> order_;
+
+    // Syllables: start syllables and each row's edges, heaviest first
+    std::vector<uint32_t> start_order_;
+    std::vector<uint32_t> edge_order_;
+    std::unordered_set<uint64_t> listed_;
+
+    std::vector<Node> arena_;
+    std::vector<Entry> frontier_;  // Max-heap on priority
+    std::vector<uint32_t> path_;   // Scratch for spell()
+    bool truncated_ = false;
+    double cutoff_ = 0.0;
+};
+
+#endif // NAME_ENUMERATOR_HPP
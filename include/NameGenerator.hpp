@@ -1,17 +1,34 @@
 #ifndef NAME_GENERATOR_HPP
 #define NAME_GENERATOR_HPP
 
+#include <cstdint>
+#include <functional>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <random>
 #include <memory>
 #include "ProfileData.hpp"
+#include "LengthConstrainedMarkov.hpp"
+#include "ExclusionTrie.hpp"
+#include "PatternProgram.hpp"
+#include "Rng.hpp"
+#include "MarkovBatchSampler.hpp"
 
 struct NameWithPattern {
     std::string name;
     std::string pattern;
 };
 
+// Options for NameGenerator::generateStream
+struct StreamOptions {
+    unsigned threads = 1;        // Worker threads (0 = one per core)
+    bool with_pattern = false;   // Append " [pattern]" to each line
+    bool unique = false;         // Only emit names not emitted before
+    bool bulk = false;           // Markov names via the lockstep batch kernel
+    uint64_t first_index = 0;    // Index of the first name (see generateAt)
+};
+
 enum class GenerationStrategy {
     Legacy,      // Original pattern-based generation
     Markov1,     // First-order Markov chains
@@ -24,6 +41,12 @@ enum class GenerationStrategy {
 
 class NameGenerator {
 public:
+    // Hard cap on letter-level Markov walks
+    static constexpr size_t kMaxMarkovLength = 20;
+
+    // Syllable names chain up to this many syllables after the first
+    static constexpr int kMaxExtraSyllables = 2;
+
     NameGenerator();
 
     // Load a profile for data-driven generation
@@ -32,9 +55,22 @@ public:
     // Load a second profile for blending (optional)
     void loadSecondProfile(const std::string& profile_path);
 
+    // Use already loaded profiles; many generators can share one copy
+    void setProfile(std::shared_ptr<const ProfileData> profile);
+    void setSecondProfile(std::shared_ptr<const ProfileData> profile);
+
+    // Never generate names on this list (word list or compiled .ngx,
+    // case-insensitive). Applies to every strategy, including legacy.
+    void loadExclusions(const std::string& path);
+    void setExclusions(std::shared_ptr<const ExclusionTrie> exclusions);
+
     // Set generation strategy (only applies when profile is loaded)
     void setStrategy(GenerationStrategy strategy);
 
+    // Names as used by --strategy
+    static std::string_view strategyName(GenerationStrategy strategy);
+    static bool parseStrategy(std::string_view name, GenerationStrategy& strategy);
+
     // Set min/max length constraints (0 = unbounded)
     void setMinLength(size_t min);
     void setMaxLength(size_t max);
@@ -42,6 +78,24 @@ public:
     // Generate a single name
     std::string generate();
 
+    // Append a single name to a caller-owned arena and return a view of it.
+    // Nothing is allocated once the arena has enough capacity, so reusing one
+    // arena (clear() keeps its capacity) makes generation allocation-free.
+    // The view is valid until the arena is next modified.
+    std::string_view generateInto(std::string& arena);
+
+    // Append count names to the arena, pushing the offset one past the end of
+    // each name to ends (the first name starts at the arena's old size)
+    void generateInto(std::string& arena, size_t count, std::vector<size_t>& ends);
+
+    // Name number `index` of the sequence for `seed`. Every name draws from
+    // its own random stream derived from (seed, index), so any name can be
+    // regenerated without the ones before it, and the batch and stream
+    // functions produce exactly generateAt(seed, 0), generateAt(seed, 1), ...
+    // Leaves the generator's engine positioned in that name's stream.
+    std::string generateAt(uint64_t seed, uint64_t index);
+    std::string_view generateAtInto(std::string& arena, uint64_t seed, uint64_t index);
+
     // Generate a single name with pattern/strategy information
     NameWithPattern generateWithPattern();
 
@@ -51,33 +105,101 @@ public:
     // Generate multiple names with pattern/strategy information
     std::vector<NameWithPattern> generateWithPattern(size_t count);
 
+    // Generate multiple names across worker threads (0 = one per core).
+    // Name i is generateAt(seed, i), so the output for a given seed is
+    // identical whatever the thread count. Profiles are shared, never copied.
+    std::vector<std::string> generateBatch(size_t count, unsigned threads) const;
+    std::vector<NameWithPattern> generateWithPatternBatch(size_t count, unsigned threads) const;
+
+    // Same names as generateBatch, starting at options.first_index, but
+    // formatted one per line and handed to sink in order, a few chunks at a
+    // time. With options.bulk, plain markov1/markov2 output (no blending,
+    // length bounds or exclusions) comes from MarkovBatchSampler instead:
+    // same distribution, different names, and not addressable by index.
+    // Memory use doesn't grow with count (except for the fingerprint set in
+    // unique mode, ~8-16 bytes per name). In unique mode, later duplicates
+    // are dropped and more names are drawn until count distinct names were
+    // emitted; throws if the profile runs out of new names.
+    void generateStream(uint64_t count, const StreamOptions& options,
+                        const std::function<void(std::string_view)>& sink) const;
+
     // Seed the random number generator
-    void seed(unsigned int seed);
+    void seed(uint64_t seed);
+
+    // Select the random engine (default xoshiro256++); reseeds it from the
+    // current seed, so it can be called before or after seed()
+    void setRng(RngKind kind);
 
 private:
-    std::mt19937 rng_;
+    Rng rng_;
+    uint64_t seed_;  // Base seed for deriving batch streams
 
-    // Profile-based generation
-    std::unique_ptr<ProfileData> profile_;
-    std::unique_ptr<ProfileData> profile2_;  // Optional second profile for blending
+    // Profile-based generation (immutable once loaded, shared by batch workers)
+    std::shared_ptr<const ProfileData> profile_;
+    std::shared_ptr<const ProfileData> profile2_;  // Optional second profile for blending
     GenerationStrategy strategy_ = GenerationStrategy::Markov2;
     size_t min_length_ = 0;
     size_t max_length_ = 0;
 
-    // Profile-based generation methods
-    std::string generateFromProfile();
-    std::string generateMarkov1();
-    std::string generateMarkov2();
-    std::string generateSyllable();
-    std::string generateComponent();
-    std::string generateNGram();
+    // Regeneration attempts for names violating length bounds or exclusions
+    static constexpr int kMaxAttempts = 100;
 
-    // Helper: weighted random selection
-    std::string selectWeighted(const std::vector<ProfileData::WeightedItem>& items);
+    // Optional blocklist; Markov walks avoid ending on its words and every
+    // finished name is checked against it
+    std::shared_ptr<const ExclusionTrie> exclusions_;
+    bool isExcluded(std::string_view name) const;
+
+    // Markov samplers conditioned on the length bounds (only while bounds
+    // are set); shared by batch workers
+    std::shared_ptr<const LengthConstrainedMarkov> constrained_markov1_;
+    std::shared_ptr<const LengthConstrainedMarkov> constrained_markov2_;
+    void rebuildLengthSamplers();
+
+    // Profile-based generation methods; each appends one name to out
+    void generateFromProfile(std::string& out);
+    void generateMarkov1(std::string& out);
+    void generateMarkov2(std::string& out);
+    void generateSyllable(std::string& out);
+    void generateComponent(std::string& out);
+    void generateNGram(std::string& out);
+
+    // Shared letter-level Markov walk over a profile's compiled chain
+    using MarkovAccessor = const CompiledMarkov& (ProfileData::*)() const;
+    void generateMarkovChain(MarkovAccessor accessor, std::string& out);
+
+    // Markov walk that only takes steps which can still end inside the
+    // length bounds
+    void generateConstrainedMarkov(const LengthConstrainedMarkov& sampler, std::string& out);
+
+    // Append a name from a random legacy pattern; returns the pattern
+    const std::string& generateLegacy(std::string& out);
+
+    // Append a name; returns the pattern or strategy name used
+    std::string_view generateWithPatternInto(std::string& out);
+
+    // Lockstep kernel for bulk streaming, or null when the current settings
+    // need the one-at-a-time generator
+    std::shared_ptr<const MarkovBatchSampler> makeBatchSampler() const;
+
+    // Helper: weighted random selection (O(1) via the list's alias table);
+    // null for lists that can't be sampled
+    const ProfileData::WeightedItem* selectWeighted(const ProfileData::WeightedList& items);
+
+    // Append a weighted selection from one of the profile's lists, straight
+    // from its string pool
+    void appendWeighted(const ProfileData& profile, const ProfileData::WeightedList& items, std::string& out);
 
     // Helper: get random blend point (1 or 2)
     int getBlendPoint();
 
+    // Batch helpers: run fn(worker, chunk, begin, end) for every chunk that
+    // overlaps names [begin_index, end_index), clipped to that range, each
+    // worker with its own generator copy
+    static unsigned resolveThreadCount(unsigned threads);
+    static uint64_t chunkCount(uint64_t count);
+    template <typename Fn>
+    void forEachChunk(uint64_t begin_index, uint64_t end_index, unsigned threads, Fn fn) const;
+
     // ===== LEGACY PATTERN-BASED GENERATION =====
 
     // ===== PHONETIC CHARACTER SETS =====
@@ -127,33 +249,14 @@ private:
     //   Q = Quality pair (smart consonant pair from different categories)
     std::vector<std::string> patterns_;
 
-    // Helper functions for random selection
-    char randomConsonant();          // Any consonant
-    char randomPlosive();            // Plosive/stop only
-    char randomFricative();          // Fricative only
-    char randomNasal();              // Nasal only
-    char randomLiquid();             // Liquid only
-    char randomGlide();              // Glide only
-    char randomVowel();              // Any vowel
-    char randomSpecial();            // Special ending
-    std::string randomBlend();       // Pre-defined blend
-    std::string randomQualityPair(); // Smart consonant pair
-
-    std::string generateFromPattern(const std::string& pattern);
-    std::string capitalize(std::string str);
-
-    // Pattern element generators (called by generateFromPattern)
-    std::string generateC();  // Any Consonant
-    std::string generateP();  // Plosive
-    std::string generateF();  // Fricative
-    std::string generateN();  // Nasal
-    std::string generateL();  // Liquid
-    std::string generateW();  // Glide (W = "with flow")
-    std::string generateV();  // Vowel
-    std::string generateB();  // Blend
-    std::string generateD();  // Double letter
-    std::string generateS();  // Special ending
-    std::string generateQ();  // Quality pair (smart consonant pairing)
+    // patterns_ compiled against the code tables; the pattern text is
+    // kept for --debug output
+    PatternProgram pattern_program_;
+    void compilePatterns();
+
+    // Append a name from the pattern at this index
+    void generateFromPattern(size_t pattern, std::string& out);
+    static void capitalize(std::string& str, size_t start);  // Uppercase str[start]
 };
 
 #endif // NAME_GENERATOR_HPP
@@ -0,0 +1,33 @@
+#ifndef NAME_MERGER_HPP
+#define NAME_MERGER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class OutputWriter;
+
+// Combines name files, e.g. the shards of a sharded run (namegen merge).
+//
+// concatenate() copies the files through in order. mergeUnique() writes each
+// distinct line once, in sorted order, using an external sort-merge: lines
+// are collected until the memory budget is reached, sorted and written to a
+// temporary run file, and the runs are then merged with a heap. Memory use
+// is bounded by the budget however large the inputs are, at the cost of
+// writing the data to temporary storage once.
+class NameMerger {
+public:
+    static constexpr size_t kDefaultMemoryBudget = size_t(256) << 20;
+
+    explicit NameMerger(size_t memory_budget = kDefaultMemoryBudget);
+
+    // Returns the number of lines written
+    uint64_t concatenate(const std::vector<std::string>& inputs, OutputWriter& out) const;
+    uint64_t mergeUnique(const std::vector<std::string>& inputs, OutputWriter& out) const;
+
+private:
+    size_t memory_budget_;
+};
+
+#endif // NAME_MERGER_HPP
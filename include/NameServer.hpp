@@ -0,0 +1,125 @@
+#ifndef NAME_SERVER_HPP
+#define NAME_SERVER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "NameGenerator.hpp"
+#include "ProfileRegistry.hpp"
+
+// Options for NameServer
+struct ServerOptions {
+    std::string socket_path;  // Unix domain socket to listen on, or
+    uint16_t port = 0;        // TCP port on 127.0.0.1 (when no socket path)
+    unsigned threads = 0;     // Worker threads (0 = one per core)
+    size_t memory_budget = 0; // Bytes of loaded profiles to keep (0 = all)
+    unsigned reload_interval = 0;  // Seconds between checks for changed profile files (0 = never)
+};
+
+// Long-running name service (`namegen serve`).
+//
+// Profiles are registered at startup and loaded by the first request that
+// uses them (see ProfileRegistry); after that they stay resident, up to the
+// memory budget, so a request costs only the generation itself. Clients speak a line protocol; every request
+// is one line of space-separated words:
+//
+//   GEN <count> (profile=<name> | blend=<name>:<w>,...) [profile2=<name>]
+//       [strategy=<s>] [min=<n>] [max=<n>] [seed=<n>] [start=<n>] [unique=1]
+//   PROFILES
+//   RELOAD [name]
+//   STATS
+//   PING
+//
+// and gets back either `OK <count>` followed by that many lines (one name,
+// profile name or line of Stats JSON each), `PONG`, or a single
+// `ERR <message>` line. Requests may
+// be pipelined: a client can send many lines without waiting, and the
+// requests are generated in parallel on the worker pool while the responses
+// come back in request order.
+//
+// RELOAD swaps in new versions of loaded profiles whose files changed (or
+// of the named profile) and lists the names swapped. Requests already
+// running finish on the old version; later ones get the new one. With a
+// reload interval, a background thread does the same periodically.
+class NameServer {
+public:
+    static constexpr size_t kMaxRequestNames = 1000000;
+    static constexpr size_t kMaxLineLength = 4096;
+
+    explicit NameServer(ServerOptions options);
+    ~NameServer();
+
+    NameServer(const NameServer&) = delete;
+    NameServer& operator=(const NameServer&) = delete;
+
+    // Make a profile (JSON or .ngp) available as `name`
+    void addProfile(const std::string& name, const std::string& path);
+
+    // Make every profile in a directory available, named after its file;
+    // returns how many were found
+    size_t addProfileDirectory(const std::string& directory);
+
+    // Listen and serve until the process is stopped (throws on socket errors)
+    void run();
+
+    // Answer one request line (without the newline); the response text
+    // includes its trailing newlines
+    std::string handleRequest(std::string_view line);
+
+private:
+    // Fixed set of worker threads running queued jobs
+    class WorkerPool {
+    public:
+        explicit WorkerPool(unsigned threads);
+        ~WorkerPool();
+        void submit(std::function<void()> job);
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable ready_;
+        std::deque<std::function<void()>> jobs_;
+        std::vector<std::thread> workers_;
+        bool stopping_ = false;
+    };
+
+    void serveConnection(int fd);
+    std::string answer(std::string_view line);
+
+    // Reload one profile, or all changed ones when name is empty; returns
+    // the names swapped
+    std::vector<std::string> reloadProfiles(std::string_view name);
+    void watchProfiles();
+    std::string generate(const std::vector<std::string_view>& words);
+
+    // Blended profile for a spec, mixed once and then reused
+    std::shared_ptr<const ProfileData> blendProfile(std::string_view spec);
+    static constexpr size_t kMaxCachedBlends = 64;
+
+    ServerOptions options_;
+    ProfileRegistry profiles_;
+    std::mutex blends_mutex_;
+    std::map<std::string, std::shared_ptr<const ProfileData>, std::less<>> blends_;
+    uint64_t blends_generation_ = 0;  // Bumped by every reload that clears blends_
+    std::unique_ptr<WorkerPool> pool_;
+
+    // Background reload checks
+    std::thread watcher_;
+    std::mutex watch_mutex_;
+    std::condition_variable watch_wake_;
+    bool stopping_ = false;
+
+    // Copied per request, so the legacy pattern tables are built only once
+    NameGenerator prototype_;
+    std::atomic<uint64_t> next_seed_;  // Seeds for requests without one
+};
+
+#endif // NAME_SERVER_HPP
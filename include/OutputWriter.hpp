@@ -0,0 +1,50 @@
+#ifndef OUTPUT_WRITER_HPP
+#define OUTPUT_WRITER_HPP
+
+#include <string>
+#include <string_view>
+
+// Buffered writer for bulk name output.
+//
+// Text is appended to one large reusable buffer and handed to the OS with
+// write() calls once it fills, instead of per-line iostream insertion.
+// Memory use is fixed by the buffer size, however much is written.
+class OutputWriter {
+public:
+    static constexpr size_t kDefaultBufferSize = 1 << 20;
+
+    // Write to an already-open file descriptor (e.g. 1 for stdout)
+    explicit OutputWriter(int fd, size_t buffer_size = kDefaultBufferSize);
+
+    // Create/truncate a file and write to it
+    explicit OutputWriter(const std::string& path, size_t buffer_size = kDefaultBufferSize);
+
+    ~OutputWriter();
+
+    OutputWriter(const OutputWriter&) = delete;
+    OutputWriter& operator=(const OutputWriter&) = delete;
+
+    void write(std::string_view text) {
+        if (buffer_.size() + text.size() > capacity_) {
+            flush();
+            if (text.size() > capacity_) {
+                writeAll(text);
+                return;
+            }
+        }
+        buffer_.append(text);
+    }
+
+    // Push buffered text to the OS (throws on I/O errors)
+    void flush();
+
+private:
+    void writeAll(std::string_view text);
+
+    int fd_;
+    bool owns_fd_ = false;
+    size_t capacity_;
+    std::string buffer_;
+};
+
+#endif // OUTPUT_WRITER_HPP
@@ -0,0 +1,101 @@
+#ifndef PATTERN_PROGRAM_HPP
+#define PATTERN_PROGRAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "AliasTable.hpp"
+#include "Rng.hpp"
+
+// Legacy name patterns ("CVCV", "BVCS", ...) compiled once into flat
+// instruction arrays.
+//
+// Every pattern code expands to a table of weighted pieces (a letter, a
+// blend, a doubled letter, ...). Compiling turns each pattern into a list of
+// table indices and each table into an alias table over fixed-size pieces, so
+// emitting a name is one bounded random draw and one small copy per code,
+// written straight into the caller's buffer with no strings or distributions
+// built on the way.
+class PatternProgram {
+public:
+    // Weighted pieces a pattern code expands to (each at most kMaxPieceLength chars)
+    using Alternatives = std::vector<std::pair<std::string, uint64_t>>;
+    static constexpr size_t kMaxPieceLength = 4;
+
+    PatternProgram() = default;
+
+    // Compile patterns against the code tables. Codes without a table are
+    // skipped, as the interpreter always did.
+    PatternProgram(const std::vector<std::string>& patterns, const std::map<char, Alternatives>& codes);
+
+    size_t size() const { return programs_.size(); }
+
+    // Bytes emit() may write for any pattern (longest name plus copy slack)
+    size_t bufferSize() const { return buffer_size_; }
+
+    // Pick a pattern index uniformly
+    template <typename URBG>
+    size_t choose(URBG& rng) const {
+        return static_cast<size_t>(boundedRandom(rng, programs_.size()));
+    }
+
+    // Write a name for pattern `index` to out, which must have room for
+    // bufferSize() bytes; returns the name length
+    template <typename URBG>
+    size_t emit(size_t index, URBG& rng, char* out) const {
+        const Program& program = programs_[index];
+        char* cursor = out;
+        for (uint32_t op = program.begin; op < program.end; ++op) {
+            const Table& table = tables_[ops_[op]];
+            uint32_t value = static_cast<uint32_t>(boundedRandom(rng, table.range));
+            uint32_t piece = table.first;
+            if (table.total == 0) {
+                piece += value;
+            } else {
+                // Alias lookup in 32-bit arithmetic (range fits in 32 bits)
+                uint32_t bucket = value / table.total;
+                uint32_t coin = value % table.total;
+                piece += coin < threshold_[table.first + bucket] ? bucket : alias_[table.first + bucket];
+            }
+            // Whole piece slots are copied; only `length` bytes are kept
+            std::memcpy(cursor, pieces_[piece].text, kMaxPieceLength);
+            cursor += pieces_[piece].length;
+        }
+        return static_cast<size_t>(cursor - out);
+    }
+
+private:
+    struct Piece {
+        char text[kMaxPieceLength];
+        uint8_t length;
+    };
+
+    // A code's pieces are pieces_[first, first + count). Equally weighted
+    // tables (total == 0) draw a piece directly from [0, count); others
+    // draw from [0, count * total) and resolve it through the alias table.
+    struct Table {
+        uint32_t first;
+        uint32_t range;
+        uint32_t total;
+    };
+
+    // A pattern is ops_[begin, end), one table index per code
+    struct Program {
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    std::vector<Piece> pieces_;
+    std::vector<uint64_t> threshold_;
+    std::vector<uint32_t> alias_;
+    std::vector<Table> tables_;
+    std::vector<uint8_t> ops_;
+    std::vector<Program> programs_;
+    size_t buffer_size_ = 0;
+};
+
+#endif // PATTERN_PROGRAM_HPP
@@ -0,0 +1,62 @@
+#ifndef PROFILE_ANALYZER_HPP
+#define PROFILE_ANALYZER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "NameGenerator.hpp"
+#include "ProfileData.hpp"
+
+// Options for ProfileAnalyzer::analyze
+struct AnalysisOptions {
+    size_t min_length = 0;         // Length bounds as given to the generator (0 = unbounded)
+    size_t max_length = 0;
+    size_t top = 10;               // Most likely names to list
+    std::vector<uint64_t> draws;   // Draw counts to estimate distinct names for
+    unsigned threads = 1;          // Worker threads (0 = one per core)
+};
+
+// What a profile and strategy can generate, computed from the tables rather
+// than by sampling
+struct ProfileAnalysis {
+    GenerationStrategy strategy;             // Strategy analyzed (syllable falls back to markov2)
+    std::vector<double> length_probability;  // [length]: probability of a name that long
+    double in_bounds = 1.0;                  // Share of unbounded walks that fit the length bounds
+    double names = 0.0;                      // Distinct names with nonzero probability
+    double entropy = 0.0;                    // Bits per name
+    std::vector<std::pair<uint64_t, double>> expected_distinct;  // (draws, expected distinct names)
+    std::vector<std::pair<std::string, double>> top;             // Most likely first
+};
+
+// Exact output distribution of the markov1, markov2 and syllable strategies.
+//
+// Letter-level Markov walks are analyzed by dynamic programming over (length,
+// state): each step pushes every state's probability mass along its edges,
+// so the cost is edges x lengths, however many names there are. Alongside
+// the mass, each state keeps the probability-weighted surprisal of the paths
+// reaching it (for the entropy) and a histogram of those paths' probabilities
+// in quarter-bit buckets (for name counts and distinct-name estimates). The
+// steps of each length are computed in parallel over destination states,
+// with results independent of the thread count.
+//
+// Syllable walks are at most 1 + NameGenerator::kMaxExtraSyllables syllables
+// long, so they are enumerated exactly, in parallel over start syllables.
+// Distinct syllable sequences are counted as distinct names; a name spelled
+// by two different splits (rare) is counted twice. The most likely names
+// are listed by NameEnumerator.
+//
+// With length bounds, results describe names inside the bounds, which is
+// what the generator produces (the constrained Markov sampler exactly, the
+// syllable rejection loop up to its attempt limit). Blending and exclusion
+// lists are not modelled.
+class ProfileAnalyzer {
+public:
+    // Throws std::runtime_error for other strategies, empty tables, or
+    // bounds that no name fits
+    static ProfileAnalysis analyze(const ProfileData& profile, GenerationStrategy strategy,
+                                   const AnalysisOptions& options);
+};
+
+#endif // PROFILE_ANALYZER_HPP
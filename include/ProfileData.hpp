@@ -2,53 +2,124 @@
 #define PROFILE_DATA_HPP
 
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 #include <map>
+#include <memory>
 #include <optional>
 #include <fstream>
 #include <stdexcept>
-#include <jsom/jsom.hpp>
+#include "AliasTable.hpp"
+#include "CompiledMarkov.hpp"
+#include "BinaryIO.hpp"
+#include "StringPool.hpp"
+#include "SyllableGraph.hpp"
 
-// Stores data loaded from NameAnalyzer JSON output
+class JsonStreamReader;
+
+// Stores data loaded from NameAnalyzer JSON output, or from a compiled
+// profile image (.ngp) written by saveCompiled()
 class ProfileData {
 public:
-    // Weighted item for random selection
+    // Weighted item for random selection; the value lives in the profile's
+    // string pool (see text())
     struct WeightedItem {
-        std::string value;
+        StringPool::Ref value;
         int weight;
     };
 
-    // Load profile from NameAnalyzer JSON file
-    explicit ProfileData(const std::string& json_file_path);
+    // Weighted items with a prebuilt alias table for O(1) sampling
+    class WeightedList {
+    public:
+        WeightedList() = default;
+        explicit WeightedList(std::vector<WeightedItem> items);
+
+        // Pick an item in proportion to its weight (list must not be empty)
+        template <typename URBG>
+        const WeightedItem& sample(URBG& rng) const { return items_[sampler_.sample(rng)]; }
+
+        // Empty when there is nothing to sample (no items or zero total weight)
+        bool empty() const { return sampler_.empty(); }
+        size_t size() const { return items_.size(); }
+        const std::vector<WeightedItem>& items() const { return items_; }
+
+        // Approximate heap bytes held by the items and the alias table
+        size_t memoryUsage() const;
+
+    private:
+        std::vector<WeightedItem> items_;
+        AliasTable sampler_;
+    };
+
+    // Next-item lists keyed by the context's Ref in the profile's pool
+    using MarkovTable = std::map<StringPool::Ref, WeightedList>;
+
+    // One input of a blend
+    struct BlendComponent {
+        std::shared_ptr<const ProfileData> profile;
+        double weight;
+    };
+
+    // Load profile from a NameAnalyzer JSON file or a compiled .ngp image
+    // (detected by its header). Images are mmap'd and the compiled Markov
+    // tables are used in place.
+    explicit ProfileData(const std::string& profile_path);
 
-    // Markov chain data access
-    const std::map<std::string, std::vector<WeightedItem>>& getMarkovOrder1() const { return markov_order1_; }
-    const std::map<std::string, std::vector<WeightedItem>>& getMarkovOrder2() const { return markov_order2_; }
+    // Mix profiles into one, in proportion to their weights (which need not
+    // sum to 1). Every table is merged up front into an ordinary profile, so
+    // blended names cost the same to generate as unblended ones.
+    static std::shared_ptr<const ProfileData> blend(const std::vector<BlendComponent>& components);
+
+    // Split a blend spec "a:0.6,b:0.3,c" into (profile, weight) pairs; the
+    // weight follows the last ':' and defaults to 1
+    static std::vector<std::pair<std::string, double>> parseBlendSpec(std::string_view spec);
+
+    // Write a versioned binary image of this profile
+    void saveCompiled(const std::string& image_path) const;
+
+    // True if the file starts with the compiled image header
+    static bool isCompiledImage(const std::string& path);
+
+    // Approximate bytes held by this profile (tables, strings and container
+    // overhead), for cache budgets
+    size_t memoryUsage() const;
+
+    // Text of a value or context from this profile's tables
+    std::string_view text(StringPool::Ref ref) const { return strings_.view(ref); }
+    const StringPool& strings() const { return strings_; }
+
+    // Markov chain data access (compiled to integer states at load time)
+    const CompiledMarkov& getMarkovOrder1() const { return markov_order1_; }
+    const CompiledMarkov& getMarkovOrder2() const { return markov_order2_; }
 
     // Syllable data access
-    const std::vector<WeightedItem>& getSyllablesStart() const { return syllables_start_; }
-    const std::vector<WeightedItem>& getSyllablesMiddle() const { return syllables_middle_; }
-    const std::vector<WeightedItem>& getSyllablesEnd() const { return syllables_end_; }
-    const std::map<std::string, std::vector<WeightedItem>>& getSyllableMarkov1() const { return syllable_markov1_; }
-    const std::map<std::string, std::vector<WeightedItem>>& getSyllableMarkov2() const { return syllable_markov2_; }
+    const WeightedList& getSyllablesStart() const { return syllables_start_; }
+    const WeightedList& getSyllablesMiddle() const { return syllables_middle_; }
+    const WeightedList& getSyllablesEnd() const { return syllables_end_; }
+    const MarkovTable& getSyllableMarkov1() const { return syllable_markov1_; }
+    const MarkovTable& getSyllableMarkov2() const { return syllable_markov2_; }
+
+    // Start syllables and syllable tables compiled for walking (built at load)
+    const SyllableGraph& getSyllableGraph() const { return syllable_graph_; }
 
     // Component data access
-    const std::vector<WeightedItem>& getOnsetsStart() const { return onsets_start_; }
-    const std::vector<WeightedItem>& getOnsetsMiddle() const { return onsets_middle_; }
-    const std::vector<WeightedItem>& getOnsetsEnd() const { return onsets_end_; }
-    const std::vector<WeightedItem>& getNuclei() const { return nuclei_; }
-    const std::vector<WeightedItem>& getCodas() const { return codas_; }
-    const std::vector<WeightedItem>& getCodasStart() const { return codas_start_; }
-    const std::vector<WeightedItem>& getCodasMiddle() const { return codas_middle_; }
-    const std::vector<WeightedItem>& getCodasEnd() const { return codas_end_; }
+    const WeightedList& getOnsetsStart() const { return onsets_start_; }
+    const WeightedList& getOnsetsMiddle() const { return onsets_middle_; }
+    const WeightedList& getOnsetsEnd() const { return onsets_end_; }
+    const WeightedList& getNuclei() const { return nuclei_; }
+    const WeightedList& getCodas() const { return codas_; }
+    const WeightedList& getCodasStart() const { return codas_start_; }
+    const WeightedList& getCodasMiddle() const { return codas_middle_; }
+    const WeightedList& getCodasEnd() const { return codas_end_; }
 
     // N-gram data access
-    const std::vector<WeightedItem>& getBigramsStart() const { return bigrams_start_; }
-    const std::vector<WeightedItem>& getBigramsMiddle() const { return bigrams_middle_; }
-    const std::vector<WeightedItem>& getBigramsEnd() const { return bigrams_end_; }
-    const std::vector<WeightedItem>& getTrigramsStart() const { return trigrams_start_; }
-    const std::vector<WeightedItem>& getTrigramsMiddle() const { return trigrams_middle_; }
-    const std::vector<WeightedItem>& getTrigramsEnd() const { return trigrams_end_; }
+    const WeightedList& getBigramsStart() const { return bigrams_start_; }
+    const WeightedList& getBigramsMiddle() const { return bigrams_middle_; }
+    const WeightedList& getBigramsEnd() const { return bigrams_end_; }
+    const WeightedList& getTrigramsStart() const { return trigrams_start_; }
+    const WeightedList& getTrigramsMiddle() const { return trigrams_middle_; }
+    const WeightedList& getTrigramsEnd() const { return trigrams_end_; }
 
     // Configuration metadata
     int getMarkovOrder() const { return markov_order_; }
@@ -56,40 +127,78 @@ public:
     bool hasComponents() const { return components_enabled_; }
 
 private:
-    // Helper to convert JSON object {key: count} to vector of WeightedItems
-    static std::vector<WeightedItem> jsonObjectToWeighted(const jsom::JsonDocument& obj);
+    ProfileData() = default;  // For blend()
+
+    // Compiled image format version; bump whenever the layout changes
+    static constexpr uint32_t kImageVersion = 3;
+
+    // Load tables from a compiled image
+    void loadCompiled(const std::string& image_path);
+
+    // Image (de)serialization of string-valued tables
+    static void writeList(BinaryWriter& out, const WeightedList& list);
+    WeightedList readList(BinaryReader& in) const;
+    static void writeTable(BinaryWriter& out, const MarkovTable& table);
+    MarkovTable readTable(BinaryReader& in) const;
+
+    // Load tables from NameAnalyzer JSON in one streaming pass
+    void loadJson(const std::string& path);
+
+    // Streaming readers for the JSON tables. Each consumes the next value:
+    // {key: count} lists, {context: {next: count}} maps, and letter-level
+    // chains that are compiled without an intermediate map. Values of the
+    // wrong type are skipped.
+    WeightedList readWeighted(JsonStreamReader& json);
+    void readPositional(JsonStreamReader& json, WeightedList& start, WeightedList& middle, WeightedList& end);
+    MarkovTable readMarkovTable(JsonStreamReader& json);
+    static CompiledMarkov readMarkovChain(JsonStreamReader& json, int order);
+
+    // One input of a blend helper: a table and the pool its strings are in
+    template <typename Table>
+    struct MixPart {
+        const StringPool* strings;
+        const Table* table;
+        double weight;
+    };
+
+    // Blend helpers: weighted mixtures of item distributions (per context
+    // for tables), counting only the inputs that have items. Results are
+    // interned in this profile's pool.
+    WeightedList mixLists(const std::vector<MixPart<WeightedList>>& lists);
+    MarkovTable mixTables(const std::vector<MixPart<MarkovTable>>& tables);
 
-    // Helper to convert JSON object {context: {next: count}} to markov map
-    static std::map<std::string, std::vector<WeightedItem>> jsonObjectToMarkov(const jsom::JsonDocument& obj);
+    // Strings of every table below
+    StringPool strings_;
 
     // Markov chain data (letter-level)
-    std::map<std::string, std::vector<WeightedItem>> markov_order1_;
-    std::map<std::string, std::vector<WeightedItem>> markov_order2_;
+    CompiledMarkov markov_order1_;
+    CompiledMarkov markov_order2_;
 
     // Syllable data
-    std::vector<WeightedItem> syllables_start_;
-    std::vector<WeightedItem> syllables_middle_;
-    std::vector<WeightedItem> syllables_end_;
-    std::map<std::string, std::vector<WeightedItem>> syllable_markov1_;
-    std::map<std::string, std::vector<WeightedItem>> syllable_markov2_;
+    WeightedList syllables_start_;
+    WeightedList syllables_middle_;
+    WeightedList syllables_end_;
+    MarkovTable syllable_markov1_;
+    MarkovTable syllable_markov2_;
+    SyllableGraph syllable_graph_;
 
     // Component data
-    std::vector<WeightedItem> onsets_start_;
-    std::vector<WeightedItem> onsets_middle_;
-    std::vector<WeightedItem> onsets_end_;
-    std::vector<WeightedItem> nuclei_;
-    std::vector<WeightedItem> codas_;
-    std::vector<WeightedItem> codas_start_;
-    std::vector<WeightedItem> codas_middle_;
-    std::vector<WeightedItem> codas_end_;
+    WeightedList onsets_start_;
+    WeightedList onsets_middle_;
+    WeightedList onsets_end_;
+    WeightedList nuclei_;
+    WeightedList codas_;
+    WeightedList codas_start_;
+    WeightedList codas_middle_;
+    WeightedList codas_end_;
 
     // N-gram data
-    std::vector<WeightedItem> bigrams_start_;
-    std::vector<WeightedItem> bigrams_middle_;
-    std::vector<WeightedItem> bigrams_end_;
-    std::vector<WeightedItem> trigrams_start_;
-    std::vector<WeightedItem> trigrams_middle_;
-    std::vector<WeightedItem> trigrams_end_;
+    WeightedList bigrams_start_;
+    WeightedList bigrams_middle_;
+    WeightedList bigrams_end_;
+    WeightedList trigrams_start_;
+    WeightedList trigrams_middle_;
+    WeightedList trigrams_end_;
 
     // Configuration
     int markov_order_ = 2;
@@ -0,0 +1,97 @@
+#ifndef PROFILE_REGISTRY_HPP
+#define PROFILE_REGISTRY_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "ProfileData.hpp"
+
+// Named profiles, loaded on first use and shared by every generator.
+//
+// Profiles are registered by name and path up front, but only loaded when
+// get() first asks for them. Threads asking for a profile that is already
+// loading wait for that one load instead of starting their own. Loaded
+// profiles are immutable, so one copy serves any number of generators.
+//
+// With a memory budget, the least recently used profiles are dropped from
+// the registry once the loaded total (ProfileData::memoryUsage) exceeds it.
+// Generators still holding a dropped profile keep it alive; the next get()
+// loads it again.
+//
+// reload() and reloadChanged() replace loaded profiles in place. The new
+// version is built on the calling thread while get() keeps returning the old
+// one, then published with a pointer swap. Work already running on the old
+// version finishes with it, and the old version is freed when the last user
+// drops it.
+class ProfileRegistry {
+public:
+    // memory_budget in bytes (0 = keep everything loaded)
+    explicit ProfileRegistry(size_t memory_budget = 0);
+
+    // Register a profile (JSON or .ngp); replaces an earlier registration
+    // of the same name
+    void add(const std::string& name, const std::string& path);
+
+    // Register every .json and .ngp file in a directory, named after the
+    // file (the .ngp wins when both exist); returns how many were added
+    size_t addDirectory(const std::string& directory);
+
+    // Profile by name, loading it if needed; throws for unknown names and
+    // load errors (a failed load is retried by the next call)
+    std::shared_ptr<const ProfileData> get(std::string_view name);
+
+    // Load a resident profile's file again and swap the new version in;
+    // false if the profile isn't loaded (it is read fresh on first use) or
+    // is already being reloaded. Throws on load errors, keeping the old version.
+    bool reload(std::string_view name);
+
+    // Reload every resident profile whose file changed since it was loaded;
+    // returns the names swapped. Profiles that fail to load keep their old
+    // version and are retried next time; their errors go to `errors`.
+    std::vector<std::string> reloadChanged(std::vector<std::string>* errors = nullptr);
+
+    bool contains(std::string_view name) const;
+    std::vector<std::string> names() const;
+
+    void setMemoryBudget(size_t bytes);
+
+    // Currently loaded profiles and their estimated size
+    size_t residentCount() const;
+    size_t residentBytes() const;
+
+private:
+    using Profile = std::shared_ptr<const ProfileData>;
+
+    struct Entry {
+        std::string path;
+        std::shared_future<Profile> profile;  // Invalid while not loaded
+        bool resident = false;                // Loaded and counted in the budget
+        bool reloading = false;
+        size_t bytes = 0;
+        std::filesystem::file_time_type modified;  // File time when loaded
+        std::list<std::string>::iterator recent;  // Position in recent_ while resident
+    };
+
+    // Drop least recently used profiles (except `keep`) until the budget
+    // is met; mutex_ must be held
+    void evict(const Entry* keep);
+    void unload(Entry& entry);
+
+    static std::filesystem::file_time_type modificationTime(const std::string& path);
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Entry, std::less<>> entries_;
+    std::list<std::string> recent_;  // Resident profile names, most recent first
+    size_t memory_budget_;
+    size_t resident_bytes_ = 0;
+};
+
+#endif // PROFILE_REGISTRY_HPP
@@ -0,0 +1,161 @@
+#ifndef RNG_HPP
+#define RNG_HPP
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string_view>
+
+// Random engines the generator can run on
+enum class RngKind {
+    Xoshiro256pp,  // xoshiro256++: 32 bytes of state, fastest (default)
+    Pcg64,         // PCG XSL-RR 128/64: 32 bytes of state
+    Philox,        // Philox4x32-10: counter-based, streams need no jumps
+    Mt19937        // std::mt19937_64: 2.5KB of state, for comparison
+};
+
+// 64x64 -> 128-bit multiply; returns the high half and stores the low half
+inline uint64_t mulHigh(uint64_t a, uint64_t b, uint64_t& low) {
+#if defined(__SIZEOF_INT128__)
+    __extension__ using Uint128 = unsigned __int128;  // __extension__: no -Wpedantic noise
+    Uint128 product = static_cast<Uint128>(a) * b;
+    low = static_cast<uint64_t>(product);
+    return static_cast<uint64_t>(product >> 64);
+#else
+    uint64_t a_lo = a & 0xFFFFFFFFULL, a_hi = a >> 32;
+    uint64_t b_lo = b & 0xFFFFFFFFULL, b_hi = b >> 32;
+    uint64_t lo_lo = a_lo * b_lo;
+    uint64_t hi_lo = a_hi * b_lo;
+    uint64_t lo_hi = a_lo * b_hi;
+    uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFFULL) + lo_hi;
+    low = (cross << 32) | (lo_lo & 0xFFFFFFFFULL);
+    return a_hi * b_hi + (hi_lo >> 32) + (cross >> 32);
+#endif
+}
+
+// Uniform integer in [0, range) from a 64-bit generator, free of modulo
+// bias, with no division in the common case (Lemire's multiply-shift with
+// rejection). range must be > 0.
+template <typename URBG>
+uint64_t boundedRandom(URBG& rng, uint64_t range) {
+    static_assert(URBG::min() == 0 && URBG::max() == std::numeric_limits<uint64_t>::max(),
+                  "boundedRandom needs a full 64-bit generator");
+    uint64_t low;
+    uint64_t high = mulHigh(rng(), range, low);
+    if (low < range) {
+        uint64_t threshold = (0 - range) % range;
+        while (low < threshold) {
+            high = mulHigh(rng(), range, low);
+        }
+    }
+    return high;
+}
+
+// Uniform double in [0, 1) from the top 53 bits of one draw
+template <typename URBG>
+double uniformUnit(URBG& rng) {
+    return static_cast<double>(rng() >> 11) * 0x1.0p-53;
+}
+
+// 64-bit random engine with the algorithm picked at runtime.
+//
+// The engine is a UniformRandomBitGenerator, so it works with the standard
+// distributions, but the generator uses below() and uniformUnit() instead.
+// The small engines live inline; only Mt19937 allocates its state, once.
+// Reseeding it rebuilds its 312-word state, so per-name streams cost a few
+// microseconds per name with Mt19937, against tens of ns for the others.
+//
+// seedStream() derives independent streams from one seed, for batch chunks:
+// Philox puts the stream id in its counter, so streams are disjoint by
+// construction; the other engines are seeded from a hash of (seed, stream).
+class Rng {
+public:
+    using result_type = uint64_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<uint64_t>::max(); }
+
+    explicit Rng(RngKind kind = RngKind::Xoshiro256pp, uint64_t seed = 0);
+    Rng(const Rng& other);
+    Rng& operator=(const Rng& other);
+    Rng(Rng&&) noexcept = default;
+    Rng& operator=(Rng&&) noexcept = default;
+
+    RngKind kind() const { return kind_; }
+
+    void seed(uint64_t seed) { seedStream(seed, 0); }
+    void seedStream(uint64_t seed, uint64_t stream);
+
+    result_type operator()() {
+        switch (kind_) {
+            case RngKind::Xoshiro256pp: return nextXoshiro();
+            case RngKind::Pcg64: return nextPcg();
+            case RngKind::Philox: return nextPhilox();
+            case RngKind::Mt19937: return (*mt_)();
+        }
+        return 0;
+    }
+
+    // Uniform integer in [0, range), range > 0
+    uint64_t below(uint64_t range) { return boundedRandom(*this, range); }
+
+    // Names as used by --rng
+    static const char* kindName(RngKind kind);
+    static bool parseKind(std::string_view name, RngKind& kind);
+
+private:
+    uint64_t nextXoshiro() {
+        uint64_t* s = xoshiro_;
+        const uint64_t result = rotl(s[0] + s[3], 23) + s[0];
+        const uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    uint64_t nextPcg() {
+        // state = state * multiplier + increment (mod 2^128)
+        constexpr uint64_t kMulHigh = 0x2360ED051FC65DA4ULL;
+        constexpr uint64_t kMulLow = 0x4385DF649FCCF645ULL;
+        uint64_t low;
+        uint64_t high = mulHigh(pcg_low_, kMulLow, low);
+        high += pcg_low_ * kMulHigh + pcg_high_ * kMulLow;
+        pcg_low_ = low + pcg_inc_low_;
+        pcg_high_ = high + pcg_inc_high_ + (pcg_low_ < low ? 1 : 0);
+
+        // XSL-RR output
+        uint64_t folded = pcg_high_ ^ pcg_low_;
+        unsigned rotation = static_cast<unsigned>(pcg_high_ >> 58);
+        return (folded >> rotation) | (folded << ((64 - rotation) & 63));
+    }
+
+    uint64_t nextPhilox() {
+        if (philox_index_ == 2) {
+            philoxBlock();
+            philox_index_ = 0;
+        }
+        return philox_out_[philox_index_++];
+    }
+
+    void philoxBlock();
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    RngKind kind_;
+
+    // State of the selected engine (the others stay unused)
+    uint64_t xoshiro_[4] = {};
+    uint64_t pcg_high_ = 0, pcg_low_ = 0, pcg_inc_high_ = 0, pcg_inc_low_ = 0;
+    uint64_t philox_key_ = 0;
+    uint64_t philox_block_ = 0;   // Block counter (low half of the counter)
+    uint64_t philox_stream_ = 0;  // Stream id (high half of the counter)
+    uint64_t philox_out_[2] = {};
+    unsigned philox_index_ = 2;
+    std::unique_ptr<std::mt19937_64> mt_;
+};
+
+#endif // RNG_HPP
@@ -0,0 +1,53 @@
+#ifndef SHARD_MANIFEST_HPP
+#define SHARD_MANIFEST_HPP
+
+#include <cstdint>
+#include <string>
+
+// Description of one shard of a sharded run (--shard i/N), written as JSON
+// next to the shard's output.
+//
+// A job of `total_count` names is split into `shards` contiguous index
+// ranges; shard i holds names [first_index, first_index + count) of the
+// seed's sequence. The manifest records everything that decides those names
+// (seed, engine, profile and blocklist contents, strategy, length bounds), so
+// `namegen merge` can check that shards belong to the same job and that none
+// is missing before combining them.
+struct ShardManifest {
+    uint64_t seed = 0;
+    std::string rng;
+    std::string profile;       // --profile path or --blend spec
+    std::string profile_hash;  // Hash of the profile file(s)
+    std::string profile2;
+    std::string profile2_hash;
+    std::string exclude;
+    std::string exclude_hash;
+    std::string strategy;
+    uint64_t min_length = 0;
+    uint64_t max_length = 0;
+    uint64_t total_count = 0;
+    unsigned shard = 1;        // 1-based
+    unsigned shards = 1;
+    uint64_t first_index = 0;
+    uint64_t count = 0;
+    std::string output;
+
+    void save(const std::string& path) const;
+    static ShardManifest load(const std::string& path);
+
+    // True if `other` is a shard of the same job (everything but the shard
+    // number, range and output file matches)
+    bool sameJob(const ShardManifest& other) const;
+
+    // Where the manifest for an output file goes by default
+    static std::string pathFor(const std::string& output_path) { return output_path + ".manifest.json"; }
+
+    // First global index of shard `shard` (1-based) of `shards`; shard
+    // `shards + 1` gives the end of the job
+    static uint64_t shardBegin(uint64_t total_count, unsigned shard, unsigned shards);
+
+    // Hex digest of a file's contents
+    static std::string hashFile(const std::string& path);
+};
+
+#endif // SHARD_MANIFEST_HPP
@@ -0,0 +1,113 @@
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Builds without the NAMEGEN_ENABLE_STATS CMake option compile every
+// counter and timer down to nothing
+#ifndef NAMEGEN_STATS
+#define NAMEGEN_STATS 0
+#endif
+
+// Process-wide generation counters and timers (--stats, serve STATS).
+//
+// Each thread bumps its own block of counters, so the hot path is one
+// thread-local increment with no shared cache lines or locked instructions.
+// toJson() sums the blocks of live threads and of threads that have exited.
+class Stats {
+public:
+    enum Counter : unsigned {
+        ProfileNames,       // Names from generateFromProfile
+        LegacyNames,        // Names from legacy patterns
+        Attempts,           // Strategy runs in the rejection loop
+        LengthRejects,      // Attempts outside the length bounds
+        ExclusionRejects,   // Attempts that produced an excluded name
+        AttemptsExhausted,  // Names kept despite failing every attempt
+        ConstrainedNames,   // Length-conditioned Markov walks
+        DeadEnds,           // Walks stopped at a context with no data
+        ErrorFallbacks,     // "Error" placeholders for empty tables
+        StrategyFallbacks,  // Syllable/component runs done by markov2 instead
+        WeightedDraws,      // Weighted list samples
+        BlockedEndRedraws,  // Name endings redrawn to avoid excluded words
+        BulkNames,          // Names from the lockstep batch kernel
+        UniqueDuplicates,   // Duplicates dropped in unique mode
+        ServeRequests,      // Server requests answered
+        ServeErrors,        // Server requests answered with ERR
+        kCounterCount
+    };
+
+    enum Timer : unsigned {
+        ProfileLoad,        // Loading a profile file or image
+        ProfileBlend,       // Mixing a weighted blend
+        StreamChunk,        // Generating one chunk of a stream
+        ServeRequest,       // Handling one server request
+        kTimerCount
+    };
+
+    static constexpr bool enabled() { return NAMEGEN_STATS != 0; }
+
+    static void count(Counter counter, uint64_t n = 1) {
+#if NAMEGEN_STATS
+        bump(local().counters[counter], n);
+#else
+        (void)counter;
+        (void)n;
+#endif
+    }
+
+    // Adds the lifetime of the object to a timer
+    class ScopedTimer {
+    public:
+#if NAMEGEN_STATS
+        explicit ScopedTimer(Timer timer) : timer_(timer), begin_(std::chrono::steady_clock::now()) {}
+        ~ScopedTimer() {
+            auto elapsed = std::chrono::steady_clock::now() - begin_;
+            ThreadStats& stats = local();
+            bump(stats.timer_calls[timer_], 1);
+            bump(stats.timer_ns[timer_], static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+#else
+        explicit ScopedTimer(Timer) {}
+#endif
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+#if NAMEGEN_STATS
+    private:
+        Timer timer_;
+        std::chrono::steady_clock::time_point begin_;
+#endif
+    };
+
+    // All counters and timers as one line of JSON
+    static std::string toJson();
+
+private:
+#if NAMEGEN_STATS
+    struct ThreadStats {
+        std::atomic<uint64_t> counters[kCounterCount] = {};
+        std::atomic<uint64_t> timer_calls[kTimerCount] = {};
+        std::atomic<uint64_t> timer_ns[kTimerCount] = {};
+    };
+
+    static ThreadStats& local() {
+        ThreadStats* stats = thread_stats_;
+        return stats ? *stats : attachThread();
+    }
+    static ThreadStats& attachThread();
+
+    // Only the owning thread writes its block, so a relaxed load and store
+    // is enough (and avoids a locked read-modify-write)
+    static void bump(std::atomic<uint64_t>& value, uint64_t n) {
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    static inline thread_local ThreadStats* thread_stats_ = nullptr;
+#endif
+};
+
+#endif // STATS_HPP
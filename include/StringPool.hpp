@@ -0,0 +1,70 @@
+#ifndef STRING_POOL_HPP
+#define STRING_POOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "BinaryIO.hpp"
+
+// Interned strings of one profile (syllables, onsets, codas, n-grams).
+//
+// Each distinct string is stored once in a contiguous byte arena and named
+// by a Ref: its 32-bit offset in the arena (the ID) and its length. Tables
+// hold Refs instead of std::string, so a value shared by several tables
+// costs its bytes once, and equal strings in one pool always have the same
+// Ref. Lookups by text use an open-addressing index over the arena.
+class StringPool {
+public:
+    using Id = uint32_t;
+
+    static constexpr Id kNotFound = UINT32_MAX;
+
+    struct Ref {
+        Id id = 0;
+        uint32_t length = 0;
+
+        // Within one pool, equal Refs mean equal strings
+        friend bool operator==(Ref a, Ref b) { return a.id == b.id && a.length == b.length; }
+        friend bool operator<(Ref a, Ref b) { return a.id != b.id ? a.id < b.id : a.length < b.length; }
+    };
+
+    // Add a string, or find the copy already in the pool
+    Ref intern(std::string_view text);
+
+    // Ref of a string in the pool, or one with id kNotFound
+    Ref find(std::string_view text) const;
+
+    std::string_view view(Ref ref) const { return std::string_view(arena_.data() + ref.id, ref.length); }
+
+    // True if the Ref lies inside the arena (for checking loaded images)
+    bool contains(Ref ref) const { return ref.id <= arena_.size() && ref.length <= arena_.size() - ref.id; }
+
+    size_t size() const { return count_; }
+    size_t bytes() const { return arena_.size(); }
+
+    // Heap bytes held by the arena and the index
+    size_t memoryUsage() const;
+
+    // Release spare arena capacity once no more strings will be added
+    void shrinkToFit() { arena_.shrink_to_fit(); }
+
+    // Image (de)serialization
+    void write(BinaryWriter& out) const;
+    static StringPool read(BinaryReader& in);
+
+private:
+    static constexpr Id kEmpty = UINT32_MAX;  // Unused index slot
+
+    // Slot for `text`: the one holding it, or the empty slot it would go in
+    size_t slot(std::string_view text) const;
+    void insert(Ref ref);
+    void grow();
+
+    std::string arena_;
+    std::vector<Ref> index_;  // Power-of-two open-addressing table, id == kEmpty when unused
+    size_t count_ = 0;
+};
+
+#endif // STRING_POOL_HPP
@@ -0,0 +1,122 @@
+#ifndef SYLLABLE_GRAPH_HPP
+#define SYLLABLE_GRAPH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "AliasTable.hpp"
+#include "StringPool.hpp"
+
+class ProfileData;
+
+// Syllable chains of a profile compiled to integer node IDs.
+//
+// Every syllable that can start a name or follow another becomes a node.
+// Outgoing edges are stored contiguously per context (CSR layout) with an
+// alias table over each slice, so walking a chain is integer lookups and
+// O(1) draws; no syllable text is hashed or compared.
+//
+// Order-1 contexts are single syllables (one row per node). Order-2
+// contexts are syllable pairs, read from the profile's "prev|cur" keys (a
+// space also separates, and unseparated keys are split where both halves
+// are known syllables). Pairs are grouped by their first node and sorted by
+// the second, so finding a pair's row is a binary search over integers.
+// When a pair hasn't been seen (or for the first step of a name) the walk
+// uses the order-1 row of the current syllable.
+class SyllableGraph {
+public:
+    static constexpr uint32_t kNoNode = UINT32_MAX;
+
+    SyllableGraph() = default;
+
+    // Compile the profile's start syllables and syllable tables; order-2
+    // pairs are used when the profile's Markov order is at least 2
+    static SyllableGraph build(const ProfileData& profile);
+
+    bool empty() const { return start_sampler_.empty(); }
+    size_t nodeCount() const { return nodes_.size(); }
+
+    // Text of a node, in the pool of the profile the graph was built from
+    StringPool::Ref ref(uint32_t node) const { return nodes_[node]; }
+
+    // Node for a syllable of that profile, or kNoNode (for carrying a walk
+    // over to another profile's graph)
+    uint32_t findNode(const StringPool& strings, std::string_view text) const;
+
+    // First syllable of a name, or kNoNode if there are no start syllables
+    template <typename URBG>
+    uint32_t start(URBG& rng) const {
+        return start_sampler_.empty() ? kNoNode : start_nodes_[start_sampler_.sample(rng)];
+    }
+
+    // Syllable after `current` (with `previous` before it, or kNoNode), or
+    // kNoNode at a dead end
+    template <typename URBG>
+    uint32_t next(uint32_t previous, uint32_t current, URBG& rng) const {
+        uint32_t row = rowFor(previous, current);
+        uint32_t begin = row_offsets_[row];
+        uint32_t count = row_offsets_[row + 1] - begin;
+        uint64_t total = totals_[row];
+        if (total == 0) {
+            return kNoNode;
+        }
+        uint32_t local = AliasTable::pick(boundedRandom(rng, count * total), total, &threshold_[begin], &alias_[begin]);
+        return next_[begin + local];
+    }
+
+    // Start syllables: node and weight of each, in sampling order
+    size_t startCount() const { return start_nodes_.size(); }
+    uint32_t startNode(size_t i) const { return start_nodes_[i]; }
+    uint64_t startWeight(size_t i) const { return start_weights_[i]; }
+    uint64_t startTotal() const { return start_sampler_.totalWeight(); }
+
+    // Row a walk at `current` (after `previous`, or kNoNode) draws from:
+    // the pair row if there is one, otherwise the order-1 row
+    uint32_t rowFor(uint32_t previous, uint32_t current) const {
+        if (previous != kNoNode) {
+            uint32_t pair = findPair(previous, current);
+            if (pair != kNoNode) {
+                return static_cast<uint32_t>(nodes_.size()) + pair;
+            }
+        }
+        return current;
+    }
+
+    // Outgoing edges of a row are [edgeBegin, edgeEnd); rowWeight is 0 for
+    // a dead end
+    size_t rowCount() const { return totals_.size(); }
+    uint32_t edgeBegin(uint32_t row) const { return row_offsets_[row]; }
+    uint32_t edgeEnd(uint32_t row) const { return row_offsets_[row + 1]; }
+    uint32_t edgeNode(uint32_t edge) const { return next_[edge]; }
+    uint64_t edgeWeight(uint32_t edge) const { return weights_[edge]; }
+    uint64_t rowWeight(uint32_t row) const { return totals_[row]; }
+
+    // Heap bytes held by the graph
+    size_t memoryUsage() const;
+
+private:
+    // Index of the pair context (previous, current), or kNoNode
+    uint32_t findPair(uint32_t previous, uint32_t current) const;
+
+    std::vector<StringPool::Ref> nodes_;  // Sorted, so nodes can be found by Ref
+
+    std::vector<uint32_t> start_nodes_;
+    std::vector<uint32_t> start_weights_;
+    AliasTable start_sampler_;
+
+    // Pair contexts: those starting with node p are [pair_offsets_[p],
+    // pair_offsets_[p + 1]), sorted by their second node
+    std::vector<uint32_t> pair_offsets_;
+    std::vector<uint32_t> pair_second_;
+
+    // Rows: one per node (order 1), then one per pair context
+    std::vector<uint32_t> row_offsets_;
+    std::vector<uint64_t> totals_;
+    std::vector<uint32_t> next_;
+    std::vector<uint32_t> weights_;  // Profile weights (ints), for analysis
+    std::vector<uint64_t> threshold_;
+    std::vector<uint32_t> alias_;
+};
+
+#endif // SYLLABLE_GRAPH_HPP
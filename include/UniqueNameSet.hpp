@@ -0,0 +1,42 @@
+#ifndef UNIQUE_NAME_SET_HPP
+#define UNIQUE_NAME_SET_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+// Compact set of names seen so far, for generating distinct names.
+//
+// Only a 64-bit fingerprint of each name is kept, in a fixed-size open
+// addressing table (linear probing), so memory is about 8-16 bytes per name
+// whatever the name lengths. Inserts are lock-free and may come from any
+// number of threads.
+//
+// Fingerprints can collide: with n names, the chance that any distinct name
+// is wrongly treated as a duplicate is about n^2 / 2^65 (~3e-4 for 10^8 names).
+class UniqueNameSet {
+public:
+    // Size the table for up to expected_names insertions
+    explicit UniqueNameSet(uint64_t expected_names);
+
+    // Fingerprint of a name (never 0)
+    static uint64_t fingerprint(std::string_view name);
+
+    // Insert a fingerprint; true if it wasn't present yet. Throws
+    // std::length_error when the table is too full to stay fast.
+    bool insert(uint64_t fingerprint);
+    bool insert(std::string_view name) { return insert(fingerprint(name)); }
+
+    uint64_t size() const { return size_.load(std::memory_order_relaxed); }
+    uint64_t capacity() const { return mask_ + 1; }
+    uint64_t memoryUsage() const { return capacity() * sizeof(uint64_t); }
+
+private:
+    std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+    uint64_t mask_;
+    uint64_t max_size_;
+    std::atomic<uint64_t> size_{0};
+};
+
+#endif // UNIQUE_NAME_SET_HPP
@@ -0,0 +1,71 @@
+#include "AliasTable.hpp"
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+AliasTable::AliasTable(std::span<const uint64_t> weights)
+    : threshold_(weights.size()), alias_(weights.size()) {
+    total_ = build(weights, threshold_, alias_);
+}
+
+uint64_t AliasTable::build(std::span<const uint64_t> weights,
+                           std::span<uint64_t> threshold,
+                           std::span<uint32_t> alias) {
+    const size_t n = weights.size();
+    uint64_t total = std::accumulate(weights.begin(), weights.end(), uint64_t{0});
+    if (n == 0 || total == 0) {
+        std::fill(threshold.begin(), threshold.end(), 0);
+        std::fill(alias.begin(), alias.end(), 0);
+        return 0;
+    }
+
+    // The sampling range is n * total; keep it representable
+    if (total > UINT64_MAX / n) {
+        throw std::overflow_error("AliasTable: total weight too large");
+    }
+
+    // Scale every weight by n so the average bucket height is exactly total
+    std::vector<uint64_t> scaled(n);
+    std::vector<uint32_t> small, large;
+    small.reserve(n);
+    large.reserve(n);
+
+    for (size_t i = 0; i < n; ++i) {
+        scaled[i] = weights[i] * n;
+        if (scaled[i] < total) {
+            small.push_back(static_cast<uint32_t>(i));
+        } else {
+            large.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    // Pair each under-full bucket with an over-full one
+    while (!small.empty() && !large.empty()) {
+        uint32_t s = small.back();
+        small.pop_back();
+        uint32_t l = large.back();
+        large.pop_back();
+
+        threshold[s] = scaled[s];
+        alias[s] = l;
+
+        scaled[l] = (scaled[l] + scaled[s]) - total;
+        if (scaled[l] < total) {
+            small.push_back(l);
+        } else {
+            large.push_back(l);
+        }
+    }
+
+    // Whatever is left is exactly full
+    for (uint32_t i : large) {
+        threshold[i] = total;
+        alias[i] = i;
+    }
+    for (uint32_t i : small) {
+        threshold[i] = total;
+        alias[i] = i;
+    }
+
+    return total;
+}
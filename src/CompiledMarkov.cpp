@@ -0,0 +1,348 @@
+#include "CompiledMarkov.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <span>
+#include <stdexcept>
+
+namespace {
+
+// Keep dense tables to a sane size (e.g. 4096 states = 64 symbols at order 2)
+constexpr uint64_t kMaxStates = 1u << 24;
+
+// Fixed-point scale for mixed probabilities; keeps state totals near 2^24,
+// well inside the 32-bit range the batch sampler needs
+constexpr double kMixScale = 1 << 24;
+
+bool isBoundary(char c) {
+    return c == '^' || c == '$';
+}
+
+} // namespace
+
+CompiledMarkov CompiledMarkov::compile(int order, const std::vector<Transition>& transitions) {
+    if (order < 1) {
+        throw std::invalid_argument("CompiledMarkov: order must be at least 1");
+    }
+
+    CompiledMarkov chain;
+    chain.order_ = order;
+    auto storage = std::make_shared<Storage>();
+
+    // Collect the alphabet from well-formed transitions
+    auto well_formed = [order](const Transition& t) {
+        return t.context.size() == static_cast<size_t>(order) && t.next.size() == 1 && t.weight > 0;
+    };
+
+    std::array<bool, 256> seen{};
+    for (const auto& t : transitions) {
+        if (!well_formed(t)) {
+            continue;
+        }
+        for (char c : t.context) {
+            if (!isBoundary(c)) {
+                seen[static_cast<unsigned char>(c)] = true;
+            }
+        }
+        if (!isBoundary(t.next[0])) {
+            seen[static_cast<unsigned char>(t.next[0])] = true;
+        }
+    }
+
+    // Code 0 is the boundary; real bytes follow in byte order
+    storage->symbols.push_back('\0');
+    storage->known[static_cast<unsigned char>('^')] = 1;
+    storage->codes[static_cast<unsigned char>('^')] = kBoundary;
+    for (int b = 0; b < 256; ++b) {
+        if (seen[b]) {
+            if (storage->symbols.size() > UINT8_MAX) {
+                throw std::runtime_error("CompiledMarkov: too many distinct symbols");
+            }
+            storage->codes[b] = static_cast<uint8_t>(storage->symbols.size());
+            storage->known[b] = 1;
+            storage->symbols.push_back(static_cast<char>(b));
+        }
+    }
+
+    const uint64_t symbol_count = storage->symbols.size();
+    uint64_t state_count = 1;
+    for (int i = 0; i < order; ++i) {
+        state_count *= symbol_count;
+        if (state_count > kMaxStates) {
+            throw std::runtime_error("CompiledMarkov: too many states for a dense table");
+        }
+    }
+    chain.state_count_ = static_cast<uint32_t>(state_count);
+
+    // Resolve every transition to (state, next code, weight)
+    struct Edge {
+        uint32_t state;
+        uint8_t next;
+        uint64_t weight;
+    };
+    std::vector<Edge> edges;
+    edges.reserve(transitions.size());
+
+    for (const auto& t : transitions) {
+        if (!well_formed(t)) {
+            continue;
+        }
+        uint64_t state = 0;
+        for (char c : t.context) {
+            state = state * symbol_count + (isBoundary(c) ? kBoundary : storage->codes[static_cast<unsigned char>(c)]);
+        }
+        uint8_t next = isBoundary(t.next[0]) ? kBoundary : storage->codes[static_cast<unsigned char>(t.next[0])];
+        edges.push_back({static_cast<uint32_t>(state), next, t.weight});
+    }
+
+    std::sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) {
+        return a.state != b.state ? a.state < b.state : a.next < b.next;
+    });
+
+    // Merge duplicate (state, next) pairs
+    std::vector<Edge> merged;
+    merged.reserve(edges.size());
+    for (const auto& e : edges) {
+        if (!merged.empty() && merged.back().state == e.state && merged.back().next == e.next) {
+            merged.back().weight += e.weight;
+        } else {
+            merged.push_back(e);
+        }
+    }
+
+    // Lay out CSR arrays
+    chain.transition_count_ = static_cast<uint32_t>(merged.size());
+    storage->offsets.assign(state_count + 1, 0);
+    storage->totals.assign(state_count, 0);
+    storage->next.resize(merged.size());
+    storage->threshold.resize(merged.size());
+    storage->alias.resize(merged.size());
+
+    for (const auto& e : merged) {
+        ++storage->offsets[e.state + 1];
+    }
+    for (uint64_t s = 0; s < state_count; ++s) {
+        storage->offsets[s + 1] += storage->offsets[s];
+    }
+
+    storage->weights.resize(merged.size());
+    for (size_t i = 0; i < merged.size(); ++i) {
+        storage->next[i] = merged[i].next;
+        storage->weights[i] = merged[i].weight;
+    }
+
+    // Per-state alias tables over each CSR slice
+    for (uint64_t s = 0; s < state_count; ++s) {
+        uint32_t begin = storage->offsets[s];
+        uint32_t count = storage->offsets[s + 1] - begin;
+        if (count == 0) {
+            continue;
+        }
+        storage->totals[s] = AliasTable::build(
+            std::span<const uint64_t>(storage->weights).subspan(begin, count),
+            std::span<uint64_t>(storage->threshold).subspan(begin, count),
+            std::span<uint32_t>(storage->alias).subspan(begin, count));
+    }
+
+    chain.attach(*storage);
+    chain.owner_ = std::move(storage);
+    return chain;
+}
+
+CompiledMarkov CompiledMarkov::mix(const std::vector<std::pair<const CompiledMarkov*, double>>& components) {
+    int order = 0;
+    for (const auto& [chain, weight] : components) {
+        if (!chain->empty()) {
+            order = chain->order_;
+            break;
+        }
+    }
+    if (order == 0) {
+        return {};
+    }
+
+    // context -> (weight of the components that know it, next byte -> mass)
+    struct Mixed {
+        double weight = 0;
+        std::map<char, double> next;
+    };
+    std::map<std::string, Mixed> contexts;
+
+    for (const auto& [chain, weight] : components) {
+        if (chain->empty() || weight <= 0) {
+            continue;
+        }
+        if (chain->order_ != order) {
+            throw std::invalid_argument("CompiledMarkov: cannot mix chains of different orders");
+        }
+
+        const uint32_t symbol_count = chain->symbolCount();
+        std::string context(static_cast<size_t>(order), '^');
+        for (uint32_t state = 0; state < chain->state_count_; ++state) {
+            uint64_t total = chain->totals_[state];
+            if (total == 0) {
+                continue;
+            }
+            // Digits of the state, most significant first, are the context codes
+            uint32_t digits = state;
+            for (int i = order - 1; i >= 0; --i) {
+                int code = static_cast<int>(digits % symbol_count);
+                digits /= symbol_count;
+                context[static_cast<size_t>(i)] = code == kBoundary ? '^' : chain->symbols_[code];
+            }
+
+            Mixed& mixed = contexts[context];
+            mixed.weight += weight;
+            for (uint32_t edge = chain->edgeBegin(state); edge < chain->edgeEnd(state); ++edge) {
+                int code = chain->next_[edge];
+                char next = code == kBoundary ? '$' : chain->symbols_[code];
+                mixed.next[next] += weight * static_cast<double>(chain->weights_[edge]) / static_cast<double>(total);
+            }
+        }
+    }
+
+    // Renormalize per context and quantize; every seen transition keeps a
+    // nonzero weight
+    std::vector<std::string> next_bytes;
+    next_bytes.reserve(256);
+    for (int b = 0; b < 256; ++b) {
+        next_bytes.emplace_back(1, static_cast<char>(b));
+    }
+    std::vector<Transition> transitions;
+    for (const auto& [context, mixed] : contexts) {
+        for (const auto& [next, mass] : mixed.next) {
+            double scaled = std::round(mass / mixed.weight * kMixScale);
+            transitions.push_back({context, next_bytes[static_cast<unsigned char>(next)],
+                                   std::max<uint64_t>(1, static_cast<uint64_t>(scaled))});
+        }
+    }
+    return compile(order, transitions);
+}
+
+void CompiledMarkov::attach(const Storage& storage) {
+    symbols_ = storage.symbols;
+    codes_ = storage.codes;
+    known_ = storage.known;
+    offsets_ = storage.offsets;
+    totals_ = storage.totals;
+    next_ = storage.next;
+    weights_ = storage.weights;
+    threshold_ = storage.threshold;
+    alias_ = storage.alias;
+}
+
+void CompiledMarkov::write(BinaryWriter& out) const {
+    out.put(static_cast<int32_t>(order_));
+    out.put(state_count_);
+    out.put(transition_count_);
+    out.put(static_cast<uint32_t>(symbols_.size()));
+    out.putArray(symbols_);
+    out.putArray(codes_);
+    out.putArray(known_);
+    out.putArray(offsets_);
+    out.putArray(totals_);
+    out.putArray(next_);
+    out.putArray(weights_);
+    out.putArray(threshold_);
+    out.putArray(alias_);
+}
+
+CompiledMarkov CompiledMarkov::view(BinaryReader& in, std::shared_ptr<const void> owner) {
+    CompiledMarkov chain;
+    chain.order_ = in.get<int32_t>();
+    chain.state_count_ = in.get<uint32_t>();
+    chain.transition_count_ = in.get<uint32_t>();
+    uint32_t symbol_count = in.get<uint32_t>();
+
+    chain.symbols_ = in.array<char>(symbol_count);
+    chain.codes_ = in.array<uint8_t>(symbol_count > 0 ? 256 : 0);
+    chain.known_ = in.array<uint8_t>(symbol_count > 0 ? 256 : 0);
+
+    // A chain that was never loaded has no tables at all
+    bool has_tables = chain.state_count_ > 0;
+    chain.offsets_ = in.array<uint32_t>(has_tables ? chain.state_count_ + 1 : 0);
+    chain.totals_ = in.array<uint64_t>(chain.state_count_);
+    chain.next_ = in.array<uint8_t>(chain.transition_count_);
+    chain.weights_ = in.array<uint64_t>(chain.transition_count_);
+    chain.threshold_ = in.array<uint64_t>(chain.transition_count_);
+    chain.alias_ = in.array<uint32_t>(chain.transition_count_);
+
+    // Structural checks so a damaged image can't index out of bounds: every
+    // value that sample(), advance(), symbol() or stateFor() uses as an index
+    // is validated once here
+    if (has_tables) {
+        auto corrupt = []() {
+            return std::runtime_error("Corrupt profile image: inconsistent Markov table");
+        };
+
+        if (chain.order_ < 1 || symbol_count == 0) {
+            throw corrupt();
+        }
+        uint64_t expected_states = 1;
+        for (int i = 0; i < chain.order_; ++i) {
+            expected_states *= symbol_count;
+            if (expected_states > kMaxStates) {
+                throw corrupt();
+            }
+        }
+        if (expected_states != chain.state_count_ || chain.offsets_.front() != 0 ||
+            chain.offsets_.back() != chain.transition_count_) {
+            throw corrupt();
+        }
+
+        for (int b = 0; b < 256; ++b) {
+            if (chain.known_[b] && chain.codes_[b] >= symbol_count) {
+                throw corrupt();
+            }
+        }
+        for (uint8_t next : chain.next_) {
+            if (next >= symbol_count) {
+                throw corrupt();
+            }
+        }
+
+        for (uint32_t state = 0; state < chain.state_count_; ++state) {
+            uint32_t begin = chain.offsets_[state];
+            uint32_t end = chain.offsets_[state + 1];
+            if (end < begin) {
+                throw corrupt();
+            }
+            const uint64_t count = end - begin;
+            uint64_t total = 0;
+            for (uint32_t edge = begin; edge < end; ++edge) {
+                if (chain.alias_[edge] >= count || chain.weights_[edge] > UINT64_MAX - total) {
+                    throw corrupt();
+                }
+                total += chain.weights_[edge];
+            }
+            // sample() draws from [0, count * total)
+            if (total != chain.totals_[state] || (count > 0 && total > UINT64_MAX / count)) {
+                throw corrupt();
+            }
+        }
+    }
+
+    chain.owner_ = std::move(owner);
+    return chain;
+}
+
+uint32_t CompiledMarkov::stateFor(std::string_view text) const {
+    if (state_count_ == 0) {
+        return kInvalidState;
+    }
+
+    const uint64_t symbol_count = symbols_.size();
+    const size_t take = std::min(text.size(), static_cast<size_t>(order_));
+    std::string_view tail = text.substr(text.size() - take);
+
+    // Leading start padding contributes code 0, so only the tail matters
+    uint64_t state = 0;
+    for (char c : tail) {
+        unsigned char b = static_cast<unsigned char>(c);
+        if (!known_[b]) {
+            return kInvalidState;
+        }
+        state = state * symbol_count + codes_[b];
+    }
+    return static_cast<uint32_t>(state);
+}
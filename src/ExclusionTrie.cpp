@@ -0,0 +1,205 @@
+#include "ExclusionTrie.hpp"
+#include "BinaryIO.hpp"
+#include "MappedFile.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+// Compiled list header: magic, then format version and a byte-order mark
+constexpr char kImageMagic[8] = {'N', 'G', 'E', 'X', 'C', 'L', '\0', '\0'};
+constexpr uint32_t kByteOrderMark = 0x01020304;
+
+// Slot 0 holds the root; its check value matches no node
+constexpr int32_t kRootCheck = -2;
+constexpr int32_t kFreeCheck = -1;
+
+struct TrieArrays {
+    std::vector<int32_t> base;
+    std::vector<int32_t> check;
+};
+
+bool hasImageHeader(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char header[sizeof(kImageMagic)] = {};
+    if (!file.read(header, sizeof(header))) {
+        return false;
+    }
+    return std::memcmp(header, kImageMagic, sizeof(kImageMagic)) == 0;
+}
+
+} // namespace
+
+ExclusionTrie ExclusionTrie::build(std::vector<std::string> words) {
+    for (auto& word : words) {
+        std::transform(word.begin(), word.end(), word.begin(), [](char c) {
+            return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+        });
+    }
+    words.erase(std::remove(words.begin(), words.end(), std::string()), words.end());
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+
+    auto arrays = std::make_shared<TrieArrays>();
+    auto& base = arrays->base;
+    auto& check = arrays->check;
+    base.assign(1, 0);
+    check.assign(1, kRootCheck);
+    size_t first_free = 1;
+
+    auto label_at = [&words](size_t word, size_t depth) {
+        return words[word].size() == depth ? kEndLabel : labelFor(words[word][depth]);
+    };
+
+    // Place nodes depth-first from an explicit stack. Words are
+    // sorted, so the words below a node form a contiguous range and its
+    // children are contiguous sub-ranges.
+    struct Pending {
+        int32_t node;
+        size_t begin;
+        size_t end;
+        size_t depth;
+    };
+    std::vector<Pending> stack;
+    if (!words.empty()) {
+        stack.push_back({0, 0, words.size(), 0});
+    }
+
+    std::vector<int32_t> labels;
+    std::vector<std::pair<size_t, size_t>> ranges;
+    while (!stack.empty()) {
+        Pending pending = stack.back();
+        stack.pop_back();
+
+        labels.clear();
+        ranges.clear();
+        for (size_t i = pending.begin; i < pending.end;) {
+            int32_t label = label_at(i, pending.depth);
+            size_t j = i + 1;
+            while (j < pending.end && label_at(j, pending.depth) == label) {
+                ++j;
+            }
+            labels.push_back(label);
+            ranges.emplace_back(i, j);
+            i = j;
+        }
+
+        // Find the first base where every child slot is free
+        int64_t candidate = std::max<int64_t>(1, static_cast<int64_t>(first_free) - labels.front());
+        for (;;) {
+            bool fits = true;
+            for (int32_t label : labels) {
+                size_t slot = static_cast<size_t>(candidate + label);
+                if (slot < check.size() && check[slot] != kFreeCheck) {
+                    fits = false;
+                    break;
+                }
+            }
+            if (fits) {
+                break;
+            }
+            ++candidate;
+        }
+        if (candidate + labels.back() >= INT32_MAX) {
+            throw std::length_error("ExclusionTrie: word list too large");
+        }
+
+        size_t needed = static_cast<size_t>(candidate + labels.back()) + 1;
+        if (needed > check.size()) {
+            base.resize(needed, 0);
+            check.resize(needed, kFreeCheck);
+        }
+
+        base[pending.node] = static_cast<int32_t>(candidate);
+        for (size_t k = 0; k < labels.size(); ++k) {
+            int32_t slot = static_cast<int32_t>(candidate + labels[k]);
+            check[slot] = pending.node;
+            if (labels[k] != kEndLabel) {
+                stack.push_back({slot, ranges[k].first, ranges[k].second, pending.depth + 1});
+            }
+        }
+
+        while (first_free < check.size() && check[first_free] != kFreeCheck) {
+            ++first_free;
+        }
+    }
+
+    ExclusionTrie trie;
+    trie.word_count_ = words.size();
+    trie.base_ = arrays->base;
+    trie.check_ = arrays->check;
+    trie.owner_ = std::move(arrays);
+    return trie;
+}
+
+ExclusionTrie ExclusionTrie::load(const std::string& path) {
+    if (!hasImageHeader(path)) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to open exclusion list: " + path);
+        }
+
+        std::vector<std::string> words;
+        std::string line;
+        while (std::getline(file, line)) {
+            size_t first = line.find_first_not_of(" \t\r");
+            size_t last = line.find_last_not_of(" \t\r");
+            if (first != std::string::npos) {
+                words.push_back(line.substr(first, last - first + 1));
+            }
+        }
+        return build(std::move(words));
+    }
+
+    auto image = std::make_shared<MappedFile>(path);
+    BinaryReader in(image->data(), image->size());
+    for (char c : kImageMagic) {
+        if (in.get<char>() != c) {
+            throw std::runtime_error("Not a compiled exclusion list: " + path);
+        }
+    }
+    uint32_t version = in.get<uint32_t>();
+    if (version != kImageVersion) {
+        throw std::runtime_error("Unsupported exclusion list version " + std::to_string(version) +
+                                 ", recompile " + path);
+    }
+    if (in.get<uint32_t>() != kByteOrderMark) {
+        throw std::runtime_error("Exclusion list was compiled on a machine with different byte order: " + path);
+    }
+
+    ExclusionTrie trie;
+    trie.word_count_ = in.get<uint64_t>();
+    uint32_t size = in.get<uint32_t>();
+    trie.base_ = in.array<int32_t>(size);
+    trie.check_ = in.array<int32_t>(size);
+    trie.owner_ = std::move(image);
+    return trie;
+}
+
+void ExclusionTrie::save(const std::string& path) const {
+    BinaryWriter out;
+    for (char c : kImageMagic) {
+        out.put(c);
+    }
+    out.put(kImageVersion);
+    out.put(kByteOrderMark);
+    out.put(word_count_);
+    out.put(static_cast<uint32_t>(base_.size()));
+    out.putArray(base_);
+    out.putArray(check_);
+
+    MappedFile::writeAtomically(path, out.data(), "exclusion list image");
+}
+
+bool ExclusionTrie::contains(std::string_view name) const {
+    int32_t node = root();
+    for (char c : name) {
+        node = step(node, c);
+        if (node == kNoNode) {
+            return false;
+        }
+    }
+    return isWord(node);
+}
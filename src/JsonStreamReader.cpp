@@ -0,0 +1,299 @@
+#include "JsonStreamReader.hpp"
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+JsonStreamReader::JsonStreamReader(const std::string& path, size_t buffer_size)
+    : file_(std::fopen(path.c_str(), "rb")), buffer_(buffer_size) {
+    if (!file_) {
+        throw std::runtime_error("Failed to open " + path + ": " + std::strerror(errno));
+    }
+}
+
+JsonStreamReader::~JsonStreamReader() {
+    std::fclose(file_);
+}
+
+char JsonStreamReader::peek() {
+    skipWhitespace();
+    if (position_ == size_ && !fill()) {
+        return 0;
+    }
+    return buffer_[position_];
+}
+
+bool JsonStreamReader::beginObject() {
+    if (peek() != '{') {
+        return false;
+    }
+    ++position_;
+    objects_.push_back(false);
+    return true;
+}
+
+bool JsonStreamReader::nextMember(std::string& key) {
+    if (objects_.empty()) {
+        fail("nextMember() outside an object");
+    }
+    char c = peek();
+    if (c == '}') {
+        ++position_;
+        objects_.pop_back();
+        return false;
+    }
+    if (objects_.back()) {
+        expect(',');
+        c = peek();
+    }
+    if (c != '"') {
+        fail("expected a member name");
+    }
+    ++position_;
+    readStringBody(key);
+    peek();
+    expect(':');
+    objects_.back() = true;
+    return true;
+}
+
+bool JsonStreamReader::readNumber(double& value) {
+    char c = peek();
+    if (c != '-' && (c < '0' || c > '9')) {
+        return false;
+    }
+    scratch_.clear();
+    for (;;) {
+        if (position_ == size_ && !fill()) {
+            break;
+        }
+        c = buffer_[position_];
+        if ((c < '0' || c > '9') && c != '-' && c != '+' && c != '.' && c != 'e' && c != 'E') {
+            break;
+        }
+        scratch_ += c;
+        ++position_;
+    }
+    const char* end = scratch_.data() + scratch_.size();
+    auto [stop, error] = std::from_chars(scratch_.data(), end, value);
+    if (error != std::errc() || stop != end) {
+        fail("invalid number '" + scratch_ + "'");
+    }
+    return true;
+}
+
+bool JsonStreamReader::readBool(bool& value) {
+    char c = peek();
+    if (c == 't') {
+        expectWord("true");
+        value = true;
+        return true;
+    }
+    if (c == 'f') {
+        expectWord("false");
+        value = false;
+        return true;
+    }
+    return false;
+}
+
+bool JsonStreamReader::readString(std::string& value) {
+    if (peek() != '"') {
+        return false;
+    }
+    ++position_;
+    readStringBody(value);
+    return true;
+}
+
+void JsonStreamReader::skipValue() {
+    double number;
+    bool flag;
+    switch (peek()) {
+    case '{':
+    case '[': {
+        // Only brackets and strings matter when skipping a container
+        size_t depth = 0;
+        do {
+            int c = next();
+            if (c < 0) {
+                fail("unexpected end of input");
+            } else if (c == '"') {
+                readStringBody(scratch_);
+            } else if (c == '{' || c == '[') {
+                ++depth;
+            } else if (c == '}' || c == ']') {
+                --depth;
+            }
+        } while (depth > 0);
+        break;
+    }
+    case '"':
+        readString(scratch_);
+        break;
+    case 'n':
+        expectWord("null");
+        break;
+    case 0:
+        fail("unexpected end of input");
+    default:
+        if (!readBool(flag) && !readNumber(number)) {
+            fail(std::string("unexpected character '") + buffer_[position_] + "'");
+        }
+    }
+}
+
+void JsonStreamReader::expectEnd() {
+    if (peek() != 0) {
+        fail("unexpected data after the end of the document");
+    }
+}
+
+bool JsonStreamReader::fill() {
+    position_ = 0;
+    size_ = std::fread(buffer_.data(), 1, buffer_.size(), file_);
+    if (size_ == 0 && std::ferror(file_)) {
+        fail("read error");
+    }
+    return size_ > 0;
+}
+
+int JsonStreamReader::next() {
+    if (position_ == size_ && !fill()) {
+        return -1;
+    }
+    char c = buffer_[position_++];
+    if (c == '\n') {
+        ++line_;
+    }
+    return static_cast<unsigned char>(c);
+}
+
+void JsonStreamReader::skipWhitespace() {
+    for (;;) {
+        while (position_ < size_) {
+            char c = buffer_[position_];
+            if (c == '\n') {
+                ++line_;
+            } else if (c != ' ' && c != '\t' && c != '\r') {
+                return;
+            }
+            ++position_;
+        }
+        if (!fill()) {
+            return;
+        }
+    }
+}
+
+void JsonStreamReader::expect(char c) {
+    if (next() != static_cast<unsigned char>(c)) {
+        fail(std::string("expected '") + c + "'");
+    }
+}
+
+void JsonStreamReader::expectWord(const char* word) {
+    for (const char* p = word; *p; ++p) {
+        if (next() != static_cast<unsigned char>(*p)) {
+            fail(std::string("expected '") + word + "'");
+        }
+    }
+}
+
+void JsonStreamReader::readStringBody(std::string& out) {
+    out.clear();
+    for (;;) {
+        if (position_ == size_ && !fill()) {
+            fail("unterminated string");
+        }
+
+        // Copy plain runs straight from the buffer
+        size_t begin = position_;
+        while (position_ < size_) {
+            unsigned char c = static_cast<unsigned char>(buffer_[position_]);
+            if (c == '"' || c == '\\' || c < 0x20) {
+                break;
+            }
+            ++position_;
+        }
+        out.append(buffer_.data() + begin, position_ - begin);
+        if (position_ == size_) {
+            continue;
+        }
+
+        char c = buffer_[position_++];
+        if (c == '"') {
+            return;
+        }
+        if (c != '\\') {
+            fail("control character in string");
+        }
+
+        int escape = next();
+        switch (escape) {
+        case '"': out += '"'; break;
+        case '\\': out += '\\'; break;
+        case '/': out += '/'; break;
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        case 't': out += '\t'; break;
+        case 'u': {
+            unsigned code = readHex4();
+            if (code >= 0xD800 && code < 0xDC00) {
+                // Surrogate pair
+                expect('\\');
+                expect('u');
+                unsigned low = readHex4();
+                if (low < 0xDC00 || low >= 0xE000) {
+                    fail("invalid surrogate pair");
+                }
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            }
+            // UTF-8
+            if (code < 0x80) {
+                out += static_cast<char>(code);
+            } else if (code < 0x800) {
+                out += static_cast<char>(0xC0 | (code >> 6));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else if (code < 0x10000) {
+                out += static_cast<char>(0xE0 | (code >> 12));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else {
+                out += static_cast<char>(0xF0 | (code >> 18));
+                out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+            break;
+        }
+        default:
+            fail("invalid escape in string");
+        }
+    }
+}
+
+unsigned JsonStreamReader::readHex4() {
+    unsigned code = 0;
+    for (int i = 0; i < 4; ++i) {
+        int c = next();
+        unsigned digit;
+        if (c >= '0' && c <= '9') {
+            digit = static_cast<unsigned>(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            digit = static_cast<unsigned>(c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+            digit = static_cast<unsigned>(c - 'A' + 10);
+        } else {
+            fail("invalid \\u escape");
+        }
+        code = code << 4 | digit;
+    }
+    return code;
+}
+
+void JsonStreamReader::fail(const std::string& message) const {
+    throw std::runtime_error("JSON error at line " + std::to_string(line_) + ": " + message);
+}
@@ -0,0 +1,52 @@
+#include "LengthConstrainedMarkov.hpp"
+
+LengthConstrainedMarkov::LengthConstrainedMarkov(const CompiledMarkov& chain, size_t min_length,
+                                                 size_t max_length, size_t cap)
+    : chain_(chain),
+      rows_(max_length > 0 && max_length < cap ? max_length + 1 : cap),
+      edge_count_(chain.empty() ? 0 : chain.edgeEnd(chain.stateCount() - 1)) {
+    if (chain_.empty()) {
+        return;
+    }
+
+    const uint32_t states = chain_.stateCount();
+    const size_t upper = max_length > 0 ? std::min(max_length, cap) : cap;
+    auto valid = [&](size_t length) {
+        return (length >= min_length && length <= upper) ? 1.0 : 0.0;
+    };
+
+    // finish[s] = P(valid name | walk is in state s having emitted `length`
+    // symbols), computed from the longest length backwards. Past the last
+    // row, a walk that reached the generator's cap is cut there; a walk that
+    // went past max_length can't be valid any more.
+    std::vector<double> finish(states, rows_ == cap ? valid(cap) : 0.0);
+    std::vector<double> previous(states);
+    cumulative_.assign(rows_ * edge_count_, 0.0);
+
+    for (size_t length = rows_; length-- > 0;) {
+        previous.swap(finish);  // previous now holds length + 1
+
+        for (uint32_t s = 0; s < states; ++s) {
+            uint32_t begin = chain_.edgeBegin(s);
+            uint32_t end = chain_.edgeEnd(s);
+            if (begin == end) {
+                // Dead end: the walk stops here
+                finish[s] = valid(length);
+                continue;
+            }
+
+            double total = static_cast<double>(chain_.stateWeight(s));
+            double running = 0.0;
+            for (uint32_t e = begin; e < end; ++e) {
+                int next = chain_.edgeSymbol(e);
+                double after = next == CompiledMarkov::kBoundary ?
+                               valid(length) : previous[chain_.advance(s, next)];
+                running += static_cast<double>(chain_.edgeWeight(e)) / total * after;
+                cumulative_[length * edge_count_ + e] = running;
+            }
+            finish[s] = running;
+        }
+    }
+
+    feasible_ = finish[chain_.startState()] > 0.0;
+}
@@ -0,0 +1,91 @@
+#include "MappedFile.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define NAMEGEN_HAVE_MMAP 1
+#endif
+
+MappedFile::MappedFile(const std::string& path) {
+#ifdef NAMEGEN_HAVE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open file: " + path);
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Failed to stat file: " + path);
+    }
+
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+        void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Failed to map file: " + path);
+        }
+        data_ = static_cast<const char*>(addr);
+        mapped_ = true;
+    }
+    ::close(fd);
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file: " + path);
+    }
+
+    size_ = static_cast<size_t>(file.tellg());
+    file.seekg(0);
+    buffer_.resize((size_ + sizeof(unsigned long long) - 1) / sizeof(unsigned long long));
+    if (!file.read(reinterpret_cast<char*>(buffer_.data()), static_cast<std::streamsize>(size_))) {
+        throw std::runtime_error("Failed to read file: " + path);
+    }
+    data_ = reinterpret_cast<const char*>(buffer_.data());
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef NAMEGEN_HAVE_MMAP
+    if (mapped_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+}
+
+void MappedFile::writeAtomically(const std::string& path, std::string_view bytes, const std::string& what) {
+    // A per-process suffix keeps concurrent writers off each other's files
+#ifdef NAMEGEN_HAVE_MMAP
+    const std::string temp_path = path + ".tmp" + std::to_string(::getpid());
+#else
+    const std::string temp_path = path + ".tmp" + std::to_string(std::random_device{}());
+#endif
+
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to create " + what + ": " + path);
+        }
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        file.close();
+        if (!file) {
+            std::remove(temp_path.c_str());
+            throw std::runtime_error("Failed to write " + what + ": " + path);
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temp_path, path, error);
+    if (error) {
+        std::remove(temp_path.c_str());
+        throw std::runtime_error("Failed to replace " + what + ": " + path + " (" + error.message() + ")");
+    }
+}
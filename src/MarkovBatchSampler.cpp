@@ -0,0 +1,54 @@
+#include "MarkovBatchSampler.hpp"
+#include <limits>
+
+namespace {
+
+// Dense rows cost states x symbols x 4 bytes; above this use the regular walk
+constexpr size_t kMaxTableBytes = size_t{64} << 20;
+
+} // namespace
+
+MarkovBatchSampler::MarkovBatchSampler(const CompiledMarkov& chain, size_t max_length)
+    : max_length_(static_cast<uint32_t>(std::min(max_length, kMaxLaneLength))) {
+    const uint32_t symbol_count = chain.symbolCount();
+    const uint32_t state_count = chain.stateCount();
+    if (chain.empty() || max_length_ == 0) {
+        return;
+    }
+
+    stride_ = (symbol_count + 7) / 8 * 8;
+    if (static_cast<size_t>(state_count) * stride_ * sizeof(uint32_t) > kMaxTableBytes) {
+        return;
+    }
+
+    symbols_.resize(symbol_count);
+    for (uint32_t code = 0; code < symbol_count; ++code) {
+        symbols_[code] = chain.symbol(static_cast<int>(code));
+    }
+
+    totals_.assign(state_count, 0);
+    next_base_.resize(state_count);
+    cumulative_.assign(static_cast<size_t>(state_count) * stride_, std::numeric_limits<uint32_t>::max());
+    std::vector<uint64_t> weights(symbol_count);
+    for (uint32_t state = 0; state < state_count; ++state) {
+        next_base_[state] = static_cast<uint32_t>(static_cast<uint64_t>(state) * symbol_count % state_count);
+
+        if (chain.stateWeight(state) > std::numeric_limits<uint32_t>::max()) {
+            return;
+        }
+        totals_[state] = static_cast<uint32_t>(chain.stateWeight(state));
+
+        std::fill(weights.begin(), weights.end(), 0);
+        for (uint32_t edge = chain.edgeBegin(state); edge < chain.edgeEnd(state); ++edge) {
+            weights[chain.edgeSymbol(edge)] += chain.edgeWeight(edge);
+        }
+        uint32_t* row = &cumulative_[static_cast<size_t>(state) * stride_];
+        uint64_t running = 0;
+        for (uint32_t code = 0; code < symbol_count; ++code) {
+            running += weights[code];
+            row[code] = static_cast<uint32_t>(running);
+        }
+    }
+
+    feasible_ = true;
+}
@@ -0,0 +1,299 @@
+#include "NameEnumerator.hpp"
+#include <algorithm>
+#include <cctype>
+#include <numeric>
+#include <stdexcept>
+#include "UniqueNameSet.hpp"
+
+namespace {
+
+// Rough heap cost of one entry of the listed-names set
+constexpr size_t kListedBytes = sizeof(uint64_t) + 2 * sizeof(void*);
+
+} // namespace
+
+NameEnumerator::NameEnumerator(const ProfileData& profile, GenerationStrategy strategy, size_t min_length,
+                               size_t max_length, size_t memory_budget)
+    : profile_(profile), strategy_(strategy), min_length_(min_length), max_length_(max_length),
+      memory_budget_(memory_budget) {
+    // Like the generator, the syllable strategy uses markov2 without syllables
+    if (strategy_ == GenerationStrategy::Syllable && !profile_.hasSyllables()) {
+        strategy_ = GenerationStrategy::Markov2;
+    }
+
+    if (strategy_ == GenerationStrategy::Markov1 || strategy_ == GenerationStrategy::Markov2) {
+        chain_ = strategy_ == GenerationStrategy::Markov1 ? &profile_.getMarkovOrder1() : &profile_.getMarkovOrder2();
+        if (chain_->empty()) {
+            throw std::runtime_error("profile has no " + std::string(NameGenerator::strategyName(strategy_)) +
+                                     " chain");
+        }
+        const uint32_t states = chain_->stateCount();
+        const uint32_t edges = chain_->edgeEnd(states - 1);
+        const size_t cap = NameGenerator::kMaxMarkovLength;
+
+        // best_[length][s]: probability of the likeliest way to finish inside
+        // the bounds from state s after `length` symbols, from the cap back.
+        // The generator's walk stops at the cap and at dead ends.
+        best_.assign((cap + 1) * states, 0.0);
+        order_.assign(cap * size_t(edges), 0);
+        std::vector<double> keys;
+        for (size_t length = cap + 1; length-- > 0;) {
+            for (uint32_t s = 0; s < states; ++s) {
+                uint64_t total = chain_->stateWeight(s);
+                if (length == cap || total == 0) {
+                    best_[length * states + s] = fits(length) ? 1.0 : 0.0;
+                    continue;
+                }
+                uint32_t begin = chain_->edgeBegin(s);
+                uint32_t count = chain_->edgeEnd(s) - begin;
+                keys.resize(count);
+                for (uint32_t local = 0; local < count; ++local) {
+                    double q = static_cast<double>(chain_->edgeWeight(begin + local)) / static_cast<double>(total);
+                    int symbol = chain_->edgeSymbol(begin + local);
+                    keys[local] = symbol == CompiledMarkov::kBoundary ? (fits(length) ? q : 0.0) :
+                                  q * best_[(length + 1) * states + chain_->advance(s, symbol)];
+                }
+                uint8_t* order = &order_[length * edges + begin];
+                std::iota(order, order + count, uint8_t(0));
+                std::stable_sort(order, order + count, [&](uint8_t a, uint8_t b) { return keys[a] > keys[b]; });
+                best_[length * states + s] = count > 0 ? keys[order[0]] : 0.0;
+            }
+        }
+        arena_.push_back({1.0, kNoParent, chain_->startState(), 0, 0});
+    } else if (strategy_ == GenerationStrategy::Syllable) {
+        const SyllableGraph& graph = profile_.getSyllableGraph();
+        if (graph.empty()) {
+            throw std::runtime_error("profile has no start syllables");
+        }
+        start_order_.resize(graph.startCount());
+        std::iota(start_order_.begin(), start_order_.end(), 0u);
+        std::stable_sort(start_order_.begin(), start_order_.end(), [&](uint32_t a, uint32_t b) {
+            return graph.startWeight(a) > graph.startWeight(b);
+        });
+        edge_order_.resize(graph.edgeBegin(static_cast<uint32_t>(graph.rowCount())));
+        std::iota(edge_order_.begin(), edge_order_.end(), 0u);
+        for (uint32_t row = 0; row < graph.rowCount(); ++row) {
+            std::stable_sort(edge_order_.begin() + graph.edgeBegin(row), edge_order_.begin() + graph.edgeEnd(row),
+                             [&](uint32_t a, uint32_t b) { return graph.edgeWeight(a) > graph.edgeWeight(b); });
+        }
+        arena_.push_back({1.0, kNoParent, SyllableGraph::kNoNode, 0, 0});
+    } else {
+        throw std::runtime_error("names can be enumerated for the markov1, markov2 and syllable strategies");
+    }
+
+    push(0, 0);
+}
+
+bool NameEnumerator::next(std::string& name, double& probability) {
+    while (!frontier_.empty()) {
+        if (frontier_.front().priority <= cutoff_) {
+            truncated_ = true;
+            break;
+        }
+        std::pop_heap(frontier_.begin(), frontier_.end());
+        Entry entry = frontier_.back();
+        frontier_.pop_back();
+
+        Node parent = arena_[entry.parent];
+        Step taken;
+        step(parent, entry.rank, taken);
+        push(entry.parent, entry.rank + 1);
+        double p = parent.probability * taken.factor;
+
+        if (taken.complete) {
+            spell(entry.parent, name);
+            if (chain_ == nullptr) {
+                if (name.empty()) {
+                    name = "Error";  // As the generator writes for an empty start syllable
+                }
+                if (!listed_.insert(UniqueNameSet::fingerprint(name)).second) {
+                    continue;
+                }
+            }
+            if (!name.empty()) {
+                name[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(name[0])));
+            }
+            probability = p;
+            enforceBudget();
+            return true;
+        }
+
+        arena_.push_back({p, entry.parent, taken.state, static_cast<uint16_t>(taken.length),
+                          static_cast<uint16_t>(parent.depth + 1)});
+        push(static_cast<uint32_t>(arena_.size() - 1), 0);
+        enforceBudget();
+    }
+    return false;
+}
+
+size_t NameEnumerator::memoryUsage() const {
+    return arena_.capacity() * sizeof(Node) + frontier_.capacity() * sizeof(Entry) +
+           listed_.size() * kListedBytes + best_.capacity() * sizeof(double) + order_.capacity() +
+           (start_order_.capacity() + edge_order_.capacity()) * sizeof(uint32_t);
+}
+
+bool NameEnumerator::step(const Node& node, uint32_t rank, Step& out) const {
+    return chain_ ? stepMarkov(node, rank, out) : stepSyllable(node, rank, out);
+}
+
+bool NameEnumerator::stepMarkov(const Node& node, uint32_t rank, Step& out) const {
+    const uint32_t states = chain_->stateCount();
+    const uint32_t edges = chain_->edgeEnd(states - 1);
+    uint64_t total = chain_->stateWeight(node.state);
+
+    // At the cap or a dead end, the only step is to stop
+    if (node.length == NameGenerator::kMaxMarkovLength || total == 0) {
+        out = {1.0, 1.0, true, 0, 0};
+        return rank == 0 && fits(node.length);
+    }
+
+    // Steps are sorted by priority, so the first zero ends the list
+    uint32_t begin = chain_->edgeBegin(node.state);
+    if (rank >= chain_->edgeEnd(node.state) - begin) {
+        return false;
+    }
+    uint32_t edge = begin + order_[size_t(node.length) * edges + begin + rank];
+    double q = static_cast<double>(chain_->edgeWeight(edge)) / static_cast<double>(total);
+    int symbol = chain_->edgeSymbol(edge);
+    if (symbol == CompiledMarkov::kBoundary) {
+        out = {fits(node.length) ? q : 0.0, q, true, 0, 0};
+    } else {
+        uint32_t state = chain_->advance(node.state, symbol);
+        out = {q * best_[size_t(node.length + 1) * states + state], q, false, state, node.length + 1u};
+    }
+    return out.priority > 0.0;
+}
+
+bool NameEnumerator::stepSyllable(const Node& node, uint32_t rank, Step& out) const {
+    const SyllableGraph& graph = profile_.getSyllableGraph();
+
+    if (node.parent == kNoParent) {
+        if (rank >= start_order_.size()) {
+            return false;
+        }
+        uint32_t start = start_order_[rank];
+        double q = static_cast<double>(graph.startWeight(start)) / static_cast<double>(graph.startTotal());
+        uint32_t syllable = graph.startNode(start);
+        out = {q, q, false, syllable, graph.ref(syllable).length};
+        return q > 0.0;
+    }
+
+    // Same stopping rule as the generator: after the drawn number of extra
+    // syllables (uniform up to kMaxExtraSyllables), or at a dead end
+    bool error = node.depth == 1 && graph.ref(node.state).length == 0;
+    uint32_t row = graph.rowFor(arena_[node.parent].state, node.state);
+    uint64_t total = graph.rowWeight(row);
+    int remaining = NameGenerator::kMaxExtraSyllables - (node.depth - 1);
+    double stop = error || total == 0 || remaining == 0 ? 1.0 : 1.0 / (remaining + 1);
+    double go = 1.0 - stop;
+    uint32_t begin = graph.edgeBegin(row);
+    uint32_t count = stop == 1.0 ? 0 : graph.edgeEnd(row) - begin;
+
+    // Stopping ranks among the edges by its probability; a stop outside the
+    // bounds is left out
+    bool can_stop = fits(error ? 5 : node.length);
+    uint32_t stop_rank = count;
+    if (can_stop) {
+        auto above = std::partition_point(edge_order_.begin() + begin, edge_order_.begin() + begin + count,
+                                          [&](uint32_t edge) {
+                                              return go * static_cast<double>(graph.edgeWeight(edge)) /
+                                                     static_cast<double>(total) > stop;
+                                          });
+        stop_rank = static_cast<uint32_t>(above - (edge_order_.begin() + begin));
+    }
+    if (rank >= count + (can_stop ? 1 : 0)) {
+        return false;
+    }
+    if (can_stop && rank == stop_rank) {
+        out = {stop, stop, true, 0, 0};
+        return true;
+    }
+
+    uint32_t edge = edge_order_[begin + (can_stop && rank > stop_rank ? rank - 1 : rank)];
+    double q = go * static_cast<double>(graph.edgeWeight(edge)) / static_cast<double>(total);
+    uint32_t syllable = graph.edgeNode(edge);
+    uint32_t length = node.length + graph.ref(syllable).length;
+
+    // Longer than the bounds allow: the name can only grow, so skip it
+    out = {max_length_ > 0 && length > max_length_ ? 0.0 : q, q, false, syllable, length};
+    return true;
+}
+
+void NameEnumerator::push(uint32_t parent, uint32_t rank) {
+    Step next;
+    for (; step(arena_[parent], rank, next); ++rank) {
+        if (next.priority > 0.0) {
+            frontier_.push_back({arena_[parent].probability * next.priority, parent, rank});
+            std::push_heap(frontier_.begin(), frontier_.end());
+            return;
+        }
+    }
+}
+
+void NameEnumerator::spell(uint32_t node, std::string& name) {
+    path_.clear();
+    for (; arena_[node].parent != kNoParent; node = arena_[node].parent) {
+        path_.push_back(node);
+    }
+    name.clear();
+    for (auto it = path_.rbegin(); it != path_.rend(); ++it) {
+        uint32_t state = arena_[*it].state;
+        if (chain_) {
+            // The last symbol of an order-k state is its lowest base-S digit
+            name += chain_->symbol(static_cast<int>(state % chain_->symbolCount()));
+        } else {
+            name += profile_.text(profile_.getSyllableGraph().ref(state));
+        }
+    }
+}
+
+void NameEnumerator::enforceBudget() {
+    auto used = [this]() {
+        return arena_.size() * sizeof(Node) + frontier_.size() * sizeof(Entry) + listed_.size() * kListedBytes;
+    };
+    if (used() <= memory_budget_) {
+        return;
+    }
+
+    // Drop nodes nothing in the frontier leads back to; if that isn't
+    // enough, give up the least likely half of the frontier
+    collect();
+    while (used() > memory_budget_ / 4 * 3 && !frontier_.empty()) {
+        std::sort(frontier_.begin(), frontier_.end(), [](const Entry& a, const Entry& b) { return b < a; });
+        size_t keep = frontier_.size() / 2;
+        cutoff_ = std::max(cutoff_, frontier_[keep].priority);
+        frontier_.resize(keep);
+        std::make_heap(frontier_.begin(), frontier_.end());
+        collect();
+    }
+}
+
+void NameEnumerator::collect() {
+    // Mark the frontier's nodes and their ancestors (parents always come
+    // first in the arena), then slide the marked nodes down in order
+    std::vector<uint32_t> index(arena_.size(), 0);
+    index[0] = 1;
+    for (const Entry& entry : frontier_) {
+        index[entry.parent] = 1;
+    }
+    for (size_t i = arena_.size(); i-- > 1;) {
+        if (index[i]) {
+            index[arena_[i].parent] = 1;
+        }
+    }
+    uint32_t kept = 0;
+    for (size_t i = 0; i < arena_.size(); ++i) {
+        if (index[i]) {
+            Node node = arena_[i];
+            if (node.parent != kNoParent) {
+                node.parent = index[node.parent];
+            }
+            index[i] = kept;
+            arena_[kept++] = node;
+        }
+    }
+    arena_.resize(kept);
+    for (Entry& entry : frontier_) {
+        entry.parent = index[entry.parent];
+    }
+}
@@ -1,10 +1,38 @@
 #include "NameGenerator.hpp"
 #include <algorithm>
+#include <atomic>
 #include <cctype>
-#include <numeric>
+#include <exception>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include "Stats.hpp"
+#include "UniqueNameSet.hpp"
+
+namespace {
+
+// Names per batch chunk; each chunk gets its own RNG stream, so the chunk
+// size (not the thread count) fixes which stream generates which name
+constexpr size_t kBatchChunkSize = 1024;
+
+// Redraws allowed when a Markov walk tries to end on an excluded word
+constexpr int kBlockedEndRetries = 8;
+
+// Every attempt hit the exclusion list; the name we'd have to keep is one the
+// caller asked never to see, so fail like unique-mode exhaustion does
+[[noreturn]] void exclusionsExhausted() {
+    Stats::count(Stats::AttemptsExhausted);
+    throw std::runtime_error("Name space exhausted: every attempt produced an excluded name");
+}
+
+} // namespace
+
+NameGenerator::NameGenerator() : seed_(std::random_device{}()) {
+    rng_.seed(seed_);
 
-NameGenerator::NameGenerator() : rng_(std::random_device{}()) {
     // Initialize consonant blends
     consonant_blends_ = {
         "bl", "br", "ch", "cl", "cr", "dr", "fl", "fr", "gl", "gr",
@@ -112,18 +140,130 @@ NameGenerator::NameGenerator() : rng_(std::random_device{}()) {
         "QVCVC",  // Quality pair with longer tail
         "VQVC",   // Quality pair in middle
     };
+
+    compilePatterns();
 }
 
-void NameGenerator::seed(unsigned int seed) {
+void NameGenerator::compilePatterns() {
+    // Each pattern code expands to a table of weighted pieces:
+    //
+    //   BASIC:
+    //     C = any Consonant
+    //     V = Vowel
+    //
+    //   PHONETIC CONSONANTS (organized by how they're pronounced):
+    //     P = Plosive/stop (b,d,g,k,p,t)     - percussive
+    //     F = Fricative (f,h,s,v,x,z)        - breathy
+    //     N = Nasal (m,n)                    - humming
+    //     L = Liquid (l,r)                   - flowing
+    //     W = Glide (w,j)                    - sliding
+    //
+    //   SPECIAL:
+    //     B = pre-defined Blend (sh,tr,bl)   - known good pairs
+    //     Q = Quality pair                   - smart auto-pairing
+    //     D = Double letter                  - repeated character
+    //     S = Special ending (x,z,k)         - modern/tech feel
+    //
+    // Unknown codes are skipped, which allows for future extension.
+    auto letters = [](std::string_view set, uint64_t weight) {
+        PatternProgram::Alternatives pieces;
+        for (char c : set) {
+            pieces.emplace_back(std::string(1, c), weight);
+        }
+        return pieces;
+    };
+
+    std::map<char, PatternProgram::Alternatives> codes;
+    codes['C'] = letters(consonants_, 1);
+    codes['V'] = letters(vowels_, 1);
+    codes['P'] = letters(plosives_, 1);
+    codes['F'] = letters(fricatives_, 1);
+    codes['N'] = letters(nasals_, 1);
+    codes['L'] = letters(liquids_, 1);
+    codes['W'] = letters(glides_, 1);
+    codes['S'] = letters(special_endings_, 1);
+
+    for (const auto& blend : consonant_blends_) {
+        codes['B'].emplace_back(blend, 1);
+    }
+
+    // D = Double letter: a vowel or a consonant with equal chance, so each
+    // side is weighted by the other side's size
+    for (char c : vowels_) {
+        codes['D'].emplace_back(std::string(2, c), consonants_.size());
+    }
+    for (char c : consonants_) {
+        codes['D'].emplace_back(std::string(2, c), vowels_.size());
+    }
+
+    // Q = Quality pair: two consonants from different phonetic categories.
+    // This avoids problematic clusters like "kt", "pb", "mg" (plosive +
+    // plosive) and creates natural-sounding combinations like "sl", "fr",
+    // "mn". Each pairing is equally likely, then each letter within it.
+    const std::pair<std::string_view, std::string_view> pairings[] = {
+        {plosives_, liquids_},     // Very common, sounds great (black, tree, play, grow)
+        {plosives_, fricatives_},  // Less common but valid (pseudo, gnostic)
+        {fricatives_, liquids_},   // Very natural (flow, slide, shred)
+        {fricatives_, nasals_},    // Less common (snack, smack via blends)
+        {liquids_, plosives_},     // Natural (old, art, help)
+        {liquids_, fricatives_},   // Common (also, mars, elf)
+        {nasals_, plosives_},      // Very natural (lamp, hand, link)
+        {nasals_, fricatives_},    // Works well (ounce, tense)
+        {glides_, plosives_},      // Less common but pronounceable
+        {glides_, fricatives_},    // Natural (wish, yes)
+    };
+    uint64_t common_size = 1;
+    for (const auto& [first, second] : pairings) {
+        common_size = std::lcm(common_size, static_cast<uint64_t>(first.size() * second.size()));
+    }
+    for (const auto& [first, second] : pairings) {
+        uint64_t weight = common_size / (first.size() * second.size());
+        for (char a : first) {
+            for (char b : second) {
+                codes['Q'].emplace_back(std::string{a, b}, weight);
+            }
+        }
+    }
+
+    pattern_program_ = PatternProgram(patterns_, codes);
+}
+
+void NameGenerator::seed(uint64_t seed) {
+    seed_ = seed;
     rng_.seed(seed);
 }
 
+void NameGenerator::setRng(RngKind kind) {
+    rng_ = Rng(kind, seed_);
+}
+
 void NameGenerator::loadProfile(const std::string& profile_path) {
-    profile_ = std::make_unique<ProfileData>(profile_path);
+    setProfile(std::make_shared<const ProfileData>(profile_path));
 }
 
 void NameGenerator::loadSecondProfile(const std::string& profile_path) {
-    profile2_ = std::make_unique<ProfileData>(profile_path);
+    setSecondProfile(std::make_shared<const ProfileData>(profile_path));
+}
+
+void NameGenerator::setProfile(std::shared_ptr<const ProfileData> profile) {
+    profile_ = std::move(profile);
+    rebuildLengthSamplers();
+}
+
+void NameGenerator::setSecondProfile(std::shared_ptr<const ProfileData> profile) {
+    profile2_ = std::move(profile);
+}
+
+void NameGenerator::loadExclusions(const std::string& path) {
+    setExclusions(std::make_shared<const ExclusionTrie>(ExclusionTrie::load(path)));
+}
+
+void NameGenerator::setExclusions(std::shared_ptr<const ExclusionTrie> exclusions) {
+    exclusions_ = std::move(exclusions);
+}
+
+bool NameGenerator::isExcluded(std::string_view name) const {
+    return exclusions_ && exclusions_->contains(name);
 }
 
 void NameGenerator::setStrategy(GenerationStrategy strategy) {
@@ -132,377 +272,494 @@ void NameGenerator::setStrategy(GenerationStrategy strategy) {
 
 int NameGenerator::getBlendPoint() {
     // Randomly return 1 or 2 for blend point
-    std::uniform_int_distribution<int> dist(1, 2);
-    return dist(rng_);
+    return 1 + static_cast<int>(rng_.below(2));
 }
 
 void NameGenerator::setMinLength(size_t min) {
     min_length_ = min;
+    rebuildLengthSamplers();
 }
 
 void NameGenerator::setMaxLength(size_t max) {
     max_length_ = max;
+    rebuildLengthSamplers();
 }
 
-std::string NameGenerator::selectWeighted(const std::vector<ProfileData::WeightedItem>& items) {
-    if (items.empty()) {
-        return "";
+void NameGenerator::rebuildLengthSamplers() {
+    constrained_markov1_.reset();
+    constrained_markov2_.reset();
+    if (!profile_ || (min_length_ == 0 && max_length_ == 0)) {
+        return;
     }
 
-    // Calculate total weight
-    int total_weight = std::accumulate(items.begin(), items.end(), 0,
-        [](int sum, const ProfileData::WeightedItem& item) {
-            return sum + item.weight;
-        });
+    constrained_markov1_ = std::make_shared<const LengthConstrainedMarkov>(
+        profile_->getMarkovOrder1(), min_length_, max_length_, kMaxMarkovLength);
+    constrained_markov2_ = std::make_shared<const LengthConstrainedMarkov>(
+        profile_->getMarkovOrder2(), min_length_, max_length_, kMaxMarkovLength);
+}
 
-    if (total_weight <= 0) {
-        return "";
+const ProfileData::WeightedItem* NameGenerator::selectWeighted(const ProfileData::WeightedList& items) {
+    if (items.empty()) {
+        return nullptr;
     }
 
-    // Random selection weighted by frequency
-    std::uniform_int_distribution<int> dist(1, total_weight);
-    int random_value = dist(rng_);
+    // O(1) draw from the alias table built when the profile was loaded
+    Stats::count(Stats::WeightedDraws);
+    return &items.sample(rng_);
+}
 
-    int cumulative = 0;
-    for (const auto& item : items) {
-        cumulative += item.weight;
-        if (random_value <= cumulative) {
-            return item.value;
-        }
+void NameGenerator::appendWeighted(const ProfileData& profile, const ProfileData::WeightedList& items,
+                                   std::string& out) {
+    if (const ProfileData::WeightedItem* item = selectWeighted(items)) {
+        out += profile.text(item->value);
     }
-
-    // Fallback (shouldn't reach here)
-    return items[0].value;
 }
 
-std::string NameGenerator::generateFromProfile() {
+void NameGenerator::generateFromProfile(std::string& out) {
     if (!profile_) {
         // No profile loaded, fall back to legacy generation
-        return generateFromPattern(patterns_[std::uniform_int_distribution<size_t>(0, patterns_.size() - 1)(rng_)]);
+        generateFromPattern(pattern_program_.choose(rng_), out);
+        return;
     }
 
     // Select strategy (random if set to Random)
     GenerationStrategy current_strategy = strategy_;
     if (strategy_ == GenerationStrategy::Random) {
-        std::uniform_int_distribution<int> strategy_dist(0, 5);
-        current_strategy = static_cast<GenerationStrategy>(strategy_dist(rng_));
+        current_strategy = static_cast<GenerationStrategy>(rng_.below(6));
+    }
+
+    Stats::count(Stats::ProfileNames);
+    const size_t start = out.size();
+    auto name = [&out, start]() { return std::string_view(out).substr(start); };
+
+    // Markov walks can be conditioned on the length bounds directly, giving
+    // a valid name in one pass. Blending switches chains mid-walk, so it keeps
+    // using the rejection loop below.
+    if (!profile2_ && (current_strategy == GenerationStrategy::Markov1 ||
+                       current_strategy == GenerationStrategy::Markov2)) {
+        const auto& sampler = current_strategy == GenerationStrategy::Markov1 ?
+                              constrained_markov1_ : constrained_markov2_;
+        if (sampler) {
+            if (sampler->feasible()) {
+                Stats::count(Stats::ConstrainedNames);
+                generateConstrainedMarkov(*sampler, out);
+                for (int attempt = 1; attempt < kMaxAttempts && isExcluded(name()); ++attempt) {
+                    Stats::count(Stats::ExclusionRejects);
+                    out.resize(start);
+                    generateConstrainedMarkov(*sampler, out);
+                }
+                if (isExcluded(name())) {
+                    exclusionsExhausted();
+                }
+                return;
+            }
+            static std::atomic<bool> warning_shown{false};
+            if (!warning_shown.exchange(true)) {
+                std::cerr << "Warning: no Markov name from this profile fits the length bounds\n";
+            }
+        }
     }
 
     // Generate using selected strategy
-    std::string name;
-    constexpr int max_attempts = 100;
     int attempts = 0;
 
     do {
+        out.resize(start);
         switch (current_strategy) {
             case GenerationStrategy::Markov1:
-                name = generateMarkov1();
+                generateMarkov1(out);
                 break;
             case GenerationStrategy::Markov2:
-                name = generateMarkov2();
+                generateMarkov2(out);
                 break;
             case GenerationStrategy::Syllable:
-                name = generateSyllable();
+                generateSyllable(out);
                 break;
             case GenerationStrategy::Component:
-                name = generateComponent();
+                generateComponent(out);
                 break;
             case GenerationStrategy::NGram:
-                name = generateNGram();
+                generateNGram(out);
                 break;
             case GenerationStrategy::Legacy:
             default:
                 // Legacy strategy doesn't support blending
                 if (profile2_) {
-                    static bool warning_shown = false;
-                    if (!warning_shown) {
+                    static std::atomic<bool> warning_shown{false};
+                    if (!warning_shown.exchange(true)) {
                         std::cerr << "Warning: legacy strategy does not support blending, using first profile only\n";
-                        warning_shown = true;
                     }
                 }
-                name = generateFromPattern(patterns_[std::uniform_int_distribution<size_t>(0, patterns_.size() - 1)(rng_)]);
+                generateFromPattern(pattern_program_.choose(rng_), out);
                 break;
         }
 
         ++attempts;
+        Stats::count(Stats::Attempts);
 
         // Check length constraints
+        size_t length = out.size() - start;
         bool meets_constraints = true;
-        if (min_length_ > 0 && name.length() < min_length_) {
+        if (min_length_ > 0 && length < min_length_) {
+            meets_constraints = false;
+        }
+        if (max_length_ > 0 && length > max_length_) {
             meets_constraints = false;
         }
-        if (max_length_ > 0 && name.length() > max_length_) {
+        if (!meets_constraints) {
+            Stats::count(Stats::LengthRejects);
+        } else if (isExcluded(name())) {
+            Stats::count(Stats::ExclusionRejects);
             meets_constraints = false;
         }
 
         if (meets_constraints) {
-            return name;
+            return;
         }
 
-    } while (attempts < max_attempts);
+    } while (attempts < kMaxAttempts);
 
-    // If we couldn't meet constraints, return what we have
-    return name;
+    // If we couldn't meet the length bounds, keep what we have, but never
+    // an excluded name
+    if (isExcluded(name())) {
+        exclusionsExhausted();
+    }
+    Stats::count(Stats::AttemptsExhausted);
+}
+
+void NameGenerator::generateMarkov1(std::string& out) {
+    generateMarkovChain(&ProfileData::getMarkovOrder1, out);
+}
+
+void NameGenerator::generateMarkov2(std::string& out) {
+    generateMarkovChain(&ProfileData::getMarkovOrder2, out);
 }
 
-std::string NameGenerator::generateMarkov1() {
-    const auto& markov = profile_->getMarkovOrder1();
-    if (markov.empty()) {
-        return "Error";
+void NameGenerator::generateMarkovChain(MarkovAccessor accessor, std::string& out) {
+    const CompiledMarkov* chain = &(profile_.get()->*accessor)();
+    if (chain->empty()) {
+        Stats::count(Stats::ErrorFallbacks);
+        out += "Error";
+        return;
     }
 
-    std::string result;
-    std::string context = "^";  // Start marker
+    const size_t start = out.size();
+    uint32_t state = chain->startState();
+    int32_t excluded_node = exclusions_ ? exclusions_->root() : ExclusionTrie::kNoNode;
     bool switched = false;
-    size_t switch_point = profile2_ ? (3 + (rng_() % 3)) : 999;  // Switch after 3-5 chars if blending
+    size_t switch_point = profile2_ ? (3 + rng_.below(3)) : 999;  // Switch after 3-5 chars if blending
+
+    for (size_t i = 0; i < kMaxMarkovLength; ++i) {
+        // Switch to profile2 if we have one and reached switch point. The
+        // profiles have different alphabets, so re-derive the state from the
+        // characters generated so far.
+        if (profile2_ && !switched && out.size() - start >= switch_point) {
+            chain = &(profile2_.get()->*accessor)();
+            state = chain->stateFor(std::string_view(out).substr(start));
+            switched = true;
+            if (state == CompiledMarkov::kInvalidState) {
+                Stats::count(Stats::DeadEnds);
+                break;
+            }
+        }
 
-    constexpr int max_length = 20;
-    for (int i = 0; i < max_length; ++i) {
-        // Switch to profile2 if we have one and reached switch point
-        const auto& current_markov = (profile2_ && !switched && result.length() >= switch_point) ?
-                                     profile2_->getMarkovOrder1() : markov;
+        int next = chain->sample(state, rng_);
 
-        if (profile2_ && !switched && result.length() >= switch_point) {
-            switched = true;
+        // Don't end on an excluded word while there are other ways to go on
+        for (int retry = 0; next == CompiledMarkov::kBoundary && retry < kBlockedEndRetries &&
+                            exclusions_ && exclusions_->isWord(excluded_node); ++retry) {
+            Stats::count(Stats::BlockedEndRedraws);
+            next = chain->sample(state, rng_);
         }
 
-        auto it = current_markov.find(context);
-        if (it == current_markov.end() || it->second.empty()) {
+        if (next == CompiledMarkov::kDeadEnd) {
+            Stats::count(Stats::DeadEnds);
             break;
         }
-
-        std::string next = selectWeighted(it->second);
-        if (next == "$") {  // End marker
+        if (next == CompiledMarkov::kBoundary) {
             break;
         }
 
-        result += next;
-        context = next;
+        out += chain->symbol(next);
+        state = chain->advance(state, next);
+        excluded_node = exclusions_ ? exclusions_->step(excluded_node, chain->symbol(next)) : ExclusionTrie::kNoNode;
     }
 
-    return capitalize(result);
+    capitalize(out, start);
 }
 
-std::string NameGenerator::generateMarkov2() {
-    const auto& markov = profile_->getMarkovOrder2();
-    if (markov.empty()) {
-        return "Error";
-    }
-
-    std::string result;
-    std::string context = "^^";  // Start marker
-    bool switched = false;
-    size_t switch_point = profile2_ ? (3 + (rng_() % 3)) : 999;  // Switch after 3-5 chars if blending
+void NameGenerator::generateConstrainedMarkov(const LengthConstrainedMarkov& sampler, std::string& out) {
+    const CompiledMarkov& chain = sampler.chain();
 
-    constexpr int max_length = 20;
-    for (int i = 0; i < max_length; ++i) {
-        // Switch to profile2 if we have one and reached switch point
-        const auto& current_markov = (profile2_ && !switched && result.length() >= switch_point) ?
-                                     profile2_->getMarkovOrder2() : markov;
+    const size_t start = out.size();
+    uint32_t state = chain.startState();
+    int32_t excluded_node = exclusions_ ? exclusions_->root() : ExclusionTrie::kNoNode;
+    for (;;) {
+        int next = sampler.sample(state, out.size() - start, rng_);
 
-        if (profile2_ && !switched && result.length() >= switch_point) {
-            switched = true;
+        // Don't end on an excluded word while there are other ways to go on
+        for (int retry = 0; next == CompiledMarkov::kBoundary && retry < kBlockedEndRetries &&
+                            exclusions_ && exclusions_->isWord(excluded_node); ++retry) {
+            Stats::count(Stats::BlockedEndRedraws);
+            next = sampler.sample(state, out.size() - start, rng_);
         }
 
-        auto it = current_markov.find(context);
-        if (it == current_markov.end() || it->second.empty()) {
+        if (next == CompiledMarkov::kBoundary) {
             break;
         }
-
-        std::string next = selectWeighted(it->second);
-        if (next == "$") {  // End marker
-            break;
-        }
-
-        result += next;
-
-        // Update context for order-2 chain
-        if (context.length() >= 2 && context[0] == '^') {
-            // Transitioning from start
-            context = context.substr(1) + next;
-        } else {
-            // Normal progression
-            context = context.substr(1) + next;
-        }
+        out += chain.symbol(next);
+        state = chain.advance(state, next);
+        excluded_node = exclusions_ ? exclusions_->step(excluded_node, chain.symbol(next)) : ExclusionTrie::kNoNode;
     }
 
-    return capitalize(result);
+    capitalize(out, start);
 }
 
-std::string NameGenerator::generateSyllable() {
+void NameGenerator::generateSyllable(std::string& out) {
     if (!profile_->hasSyllables()) {
         // Fall back to markov2
-        return generateMarkov2();
+        Stats::count(Stats::StrategyFallbacks);
+        generateMarkov2(out);
+        return;
     }
 
-    std::string result;
+    const size_t start = out.size();
 
     // Determine blend point (1 or 2 syllables from first profile)
     int blend_point = profile2_ ? getBlendPoint() : 999;
 
-    // Start with a starting syllable from profile1
-    std::string current_syl = selectWeighted(profile_->getSyllablesStart());
-    if (current_syl.empty()) {
-        return "Error";
+    // Walk profile1's compiled syllable graph from a start syllable
+    const ProfileData* graph_profile = profile_.get();
+    const SyllableGraph* graph = &profile_->getSyllableGraph();
+    uint32_t previous = SyllableGraph::kNoNode;
+    uint32_t current = graph->start(rng_);
+    if (current == SyllableGraph::kNoNode || graph->ref(current).length == 0) {
+        Stats::count(Stats::ErrorFallbacks);
+        out += "Error";
+        return;
     }
+    Stats::count(Stats::WeightedDraws);
 
-    result = current_syl;
+    out += graph_profile->text(graph->ref(current));
     int syllable_count = 1;
 
-    // Chain 1-3 more syllables
-    std::uniform_int_distribution<int> syl_count_dist(0, 2);
-    int additional_syllables = syl_count_dist(rng_);
+    // Chain up to kMaxExtraSyllables more syllables
+    int additional_syllables = static_cast<int>(rng_.below(kMaxExtraSyllables + 1));
 
     for (int i = 0; i < additional_syllables; ++i) {
-        // Switch to profile2 if we've reached blend point
-        ProfileData* current_profile = (profile2_ && syllable_count >= blend_point) ?
-                                       profile2_.get() : profile_.get();
-
-        const auto& syl_markov = current_profile->getMarkovOrder() >= 2 ?
-                                 current_profile->getSyllableMarkov2() :
-                                 current_profile->getSyllableMarkov1();
+        // Switch to profile2's graph at the blend point. Node IDs are per
+        // graph, so the context is carried over by text, once per name.
+        if (profile2_ && syllable_count >= blend_point && graph_profile != profile2_.get()) {
+            const SyllableGraph& other = profile2_->getSyllableGraph();
+            if (previous != SyllableGraph::kNoNode) {
+                previous = other.findNode(profile2_->strings(), graph_profile->text(graph->ref(previous)));
+            }
+            current = other.findNode(profile2_->strings(), graph_profile->text(graph->ref(current)));
+            graph_profile = profile2_.get();
+            graph = &other;
+            if (current == SyllableGraph::kNoNode) {
+                Stats::count(Stats::DeadEnds);
+                break;
+            }
+        }
 
-        auto it = syl_markov.find(current_syl);
-        if (it == syl_markov.end() || it->second.empty()) {
+        uint32_t next = graph->next(previous, current, rng_);
+        if (next == SyllableGraph::kNoNode) {
+            Stats::count(Stats::DeadEnds);
             break;
         }
+        Stats::count(Stats::WeightedDraws);
 
-        std::string next_syl = selectWeighted(it->second);
-        result += next_syl;
-        current_syl = next_syl;
+        previous = current;
+        current = next;
+        out += graph_profile->text(graph->ref(current));
         syllable_count++;
     }
 
-    return capitalize(result);
+    capitalize(out, start);
 }
 
-std::string NameGenerator::generateComponent() {
+void NameGenerator::generateComponent(std::string& out) {
     if (!profile_->hasComponents()) {
         // Fall back to markov2
-        return generateMarkov2();
+        Stats::count(Stats::StrategyFallbacks);
+        generateMarkov2(out);
+        return;
     }
 
-    std::string result;
+    const size_t start = out.size();
 
     // Determine blend point (1 or 2 components from first profile)
     int blend_point = profile2_ ? getBlendPoint() : 999;
 
     // Generate 1-3 syllables using component assembly
-    std::uniform_int_distribution<int> syl_count_dist(1, 3);
-    int syllable_count = syl_count_dist(rng_);
+    int syllable_count = 1 + static_cast<int>(rng_.below(3));
 
     for (int i = 0; i < syllable_count; ++i) {
         // Switch to profile2 if we've reached blend point
-        ProfileData* current_profile = (profile2_ && i >= blend_point) ?
+        const ProfileData* current_profile = (profile2_ && i >= blend_point) ?
                                        profile2_.get() : profile_.get();
 
-        std::string onset, nucleus, coda;
-
         // Select onset based on position
         if (i == 0) {
-            onset = selectWeighted(current_profile->getOnsetsStart());
+            appendWeighted(*current_profile, current_profile->getOnsetsStart(), out);
         } else if (i == syllable_count - 1) {
-            onset = selectWeighted(current_profile->getOnsetsEnd());
+            appendWeighted(*current_profile, current_profile->getOnsetsEnd(), out);
         } else {
-            onset = selectWeighted(current_profile->getOnsetsMiddle());
+            appendWeighted(*current_profile, current_profile->getOnsetsMiddle(), out);
         }
 
         // Nucleus (same for all positions)
-        nucleus = selectWeighted(current_profile->getNuclei());
+        appendWeighted(*current_profile, current_profile->getNuclei(), out);
 
         // Select coda based on position
         if (i == 0) {
-            coda = selectWeighted(current_profile->getCodasStart());
+            appendWeighted(*current_profile, current_profile->getCodasStart(), out);
         } else if (i == syllable_count - 1) {
-            coda = selectWeighted(current_profile->getCodasEnd());
+            appendWeighted(*current_profile, current_profile->getCodasEnd(), out);
         } else {
-            coda = selectWeighted(current_profile->getCodasMiddle());
+            appendWeighted(*current_profile, current_profile->getCodasMiddle(), out);
         }
-
-        result += onset + nucleus + coda;
     }
 
-    return capitalize(result);
+    capitalize(out, start);
 }
 
-std::string NameGenerator::generateNGram() {
-    std::string result;
+void NameGenerator::generateNGram(std::string& out) {
+    const size_t start = out.size();
 
     // Use profile1 for start, profile2 (if available) for middle/end
-    ProfileData* start_profile = profile_.get();
-    ProfileData* end_profile = profile2_ ? profile2_.get() : profile_.get();
+    const ProfileData* start_profile = profile_.get();
+    const ProfileData* end_profile = profile2_ ? profile2_.get() : profile_.get();
 
     // Start with a starting trigram or bigram from profile1
-    std::uniform_int_distribution<int> choice(0, 1);
-    if (choice(rng_) && !start_profile->getTrigramsStart().empty()) {
-        result = selectWeighted(start_profile->getTrigramsStart());
+    if (rng_.below(2) && !start_profile->getTrigramsStart().empty()) {
+        appendWeighted(*start_profile, start_profile->getTrigramsStart(), out);
     } else if (!start_profile->getBigramsStart().empty()) {
-        result = selectWeighted(start_profile->getBigramsStart());
+        appendWeighted(*start_profile, start_profile->getBigramsStart(), out);
     } else {
-        return "Error";
+        Stats::count(Stats::ErrorFallbacks);
+        out += "Error";
+        return;
     }
 
     // Add 1-3 middle n-grams from end_profile (blended if available)
-    std::uniform_int_distribution<int> middle_count_dist(1, 3);
-    int middle_count = middle_count_dist(rng_);
+    int middle_count = 1 + static_cast<int>(rng_.below(3));
 
     for (int i = 0; i < middle_count; ++i) {
-        if (choice(rng_) && !end_profile->getTrigramsMiddle().empty()) {
-            result += selectWeighted(end_profile->getTrigramsMiddle());
+        if (rng_.below(2) && !end_profile->getTrigramsMiddle().empty()) {
+            appendWeighted(*end_profile, end_profile->getTrigramsMiddle(), out);
         } else if (!end_profile->getBigramsMiddle().empty()) {
-            result += selectWeighted(end_profile->getBigramsMiddle());
+            appendWeighted(*end_profile, end_profile->getBigramsMiddle(), out);
         }
     }
 
     // End with an ending n-gram from end_profile
-    if (choice(rng_) && !end_profile->getTrigramsEnd().empty()) {
-        result += selectWeighted(end_profile->getTrigramsEnd());
+    if (rng_.below(2) && !end_profile->getTrigramsEnd().empty()) {
+        appendWeighted(*end_profile, end_profile->getTrigramsEnd(), out);
     } else if (!end_profile->getBigramsEnd().empty()) {
-        result += selectWeighted(end_profile->getBigramsEnd());
+        appendWeighted(*end_profile, end_profile->getBigramsEnd(), out);
     }
 
-    return capitalize(result);
+    capitalize(out, start);
 }
 
-std::string NameGenerator::generate() {
-    // If profile is loaded, use profile-based generation
+const std::string& NameGenerator::generateLegacy(std::string& out) {
+    // Pick a random pattern, again if the name is excluded
+    Stats::count(Stats::LegacyNames);
+    const size_t start = out.size();
+    size_t pattern = 0;
+    for (int attempt = 0; attempt < kMaxAttempts; ++attempt) {
+        out.resize(start);
+        pattern = pattern_program_.choose(rng_);
+        generateFromPattern(pattern, out);
+        if (!isExcluded(std::string_view(out).substr(start))) {
+            return patterns_[pattern];
+        }
+        Stats::count(Stats::ExclusionRejects);
+    }
+
+    exclusionsExhausted();
+}
+
+std::string_view NameGenerator::generateInto(std::string& arena) {
+    const size_t start = arena.size();
+
+    // If profile is loaded, use profile-based generation; otherwise use
+    // legacy pattern-based generation
     if (profile_) {
-        return generateFromProfile();
+        generateFromProfile(arena);
+    } else {
+        generateLegacy(arena);
     }
 
-    // Otherwise use legacy pattern-based generation
-    // Pick a random pattern
-    std::uniform_int_distribution<size_t> dist(0, patterns_.size() - 1);
-    const auto& pattern = patterns_[dist(rng_)];
+    return std::string_view(arena).substr(start);
+}
 
-    return generateFromPattern(pattern);
+void NameGenerator::generateInto(std::string& arena, size_t count, std::vector<size_t>& ends) {
+    for (size_t i = 0; i < count; ++i) {
+        generateInto(arena);
+        ends.push_back(arena.size());
+    }
 }
 
-NameWithPattern NameGenerator::generateWithPattern() {
+std::string_view NameGenerator::generateWithPatternInto(std::string& out) {
+    if (!profile_) {
+        return generateLegacy(out);
+    }
+
     // If profile is loaded, show strategy instead of pattern
-    if (profile_) {
-        std::string name = generateFromProfile();
-
-        // Determine which strategy was actually used
-        std::string strategy_name;
-        switch (strategy_) {
-            case GenerationStrategy::Markov1: strategy_name = "markov1"; break;
-            case GenerationStrategy::Markov2: strategy_name = "markov2"; break;
-            case GenerationStrategy::Syllable: strategy_name = "syllable"; break;
-            case GenerationStrategy::Component: strategy_name = "component"; break;
-            case GenerationStrategy::NGram: strategy_name = "ngram"; break;
-            case GenerationStrategy::Random: strategy_name = "random"; break;
-            case GenerationStrategy::Legacy: strategy_name = "legacy"; break;
-        }
+    generateFromProfile(out);
+    return strategyName(strategy_);
+}
 
-        return {name, strategy_name};
+std::string_view NameGenerator::strategyName(GenerationStrategy strategy) {
+    switch (strategy) {
+        case GenerationStrategy::Markov1: return "markov1";
+        case GenerationStrategy::Markov2: return "markov2";
+        case GenerationStrategy::Syllable: return "syllable";
+        case GenerationStrategy::Component: return "component";
+        case GenerationStrategy::NGram: return "ngram";
+        case GenerationStrategy::Random: return "random";
+        case GenerationStrategy::Legacy: return "legacy";
     }
+    return {};
+}
 
-    // Otherwise use legacy pattern-based generation
-    std::uniform_int_distribution<size_t> dist(0, patterns_.size() - 1);
-    const auto& pattern = patterns_[dist(rng_)];
+bool NameGenerator::parseStrategy(std::string_view name, GenerationStrategy& strategy) {
+    for (GenerationStrategy candidate : {GenerationStrategy::Markov1, GenerationStrategy::Markov2,
+                                         GenerationStrategy::Syllable, GenerationStrategy::Component,
+                                         GenerationStrategy::NGram, GenerationStrategy::Random,
+                                         GenerationStrategy::Legacy}) {
+        if (name == strategyName(candidate)) {
+            strategy = candidate;
+            return true;
+        }
+    }
+    return false;
+}
 
-    return {generateFromPattern(pattern), pattern};
+std::string NameGenerator::generateAt(uint64_t seed, uint64_t index) {
+    std::string name;
+    generateAtInto(name, seed, index);
+    return name;
+}
+
+std::string_view NameGenerator::generateAtInto(std::string& arena, uint64_t seed, uint64_t index) {
+    rng_.seedStream(seed, index);
+    return generateInto(arena);
+}
+
+std::string NameGenerator::generate() {
+    std::string name;
+    generateInto(name);
+    return name;
+}
+
+NameWithPattern NameGenerator::generateWithPattern() {
+    NameWithPattern result;
+    result.pattern = generateWithPatternInto(result.name);
+    return result;
 }
 
 std::vector<std::string> NameGenerator::generate(size_t count) {
@@ -527,308 +784,267 @@ std::vector<NameWithPattern> NameGenerator::generateWithPattern(size_t count) {
     return results;
 }
 
-// ===== RANDOM CHARACTER SELECTION FUNCTIONS =====
-// These functions randomly select characters from the phonetic categories
-
-char NameGenerator::randomConsonant() {
-    // Select any consonant (all phonetic categories combined)
-    std::uniform_int_distribution<size_t> dist(0, consonants_.size() - 1);
-    return consonants_[dist(rng_)];
-}
-
-char NameGenerator::randomPlosive() {
-    // Select a plosive/stop consonant: b, c, d, g, k, p, q, t
-    // These are "percussive" - air is blocked then released
-    std::uniform_int_distribution<size_t> dist(0, plosives_.size() - 1);
-    return plosives_[dist(rng_)];
-}
-
-char NameGenerator::randomFricative() {
-    // Select a fricative consonant: f, h, s, v, x, z
-    // These are "breathy" - air is forced through a narrow gap
-    std::uniform_int_distribution<size_t> dist(0, fricatives_.size() - 1);
-    return fricatives_[dist(rng_)];
+unsigned NameGenerator::resolveThreadCount(unsigned threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return threads;
 }
 
-char NameGenerator::randomNasal() {
-    // Select a nasal consonant: m, n
-    // These have a "humming" quality - air flows through the nose
-    std::uniform_int_distribution<size_t> dist(0, nasals_.size() - 1);
-    return nasals_[dist(rng_)];
-}
+template <typename Fn>
+void NameGenerator::forEachChunk(uint64_t begin_index, uint64_t end_index, unsigned threads, Fn fn) const {
+    const uint64_t first_chunk = begin_index / kBatchChunkSize;
+    const uint64_t last_chunk = chunkCount(end_index);
+    const uint64_t chunk_count = last_chunk - first_chunk;
+    threads = static_cast<unsigned>(std::min<uint64_t>(resolveThreadCount(threads), std::max<uint64_t>(chunk_count, 1)));
+
+    std::atomic<uint64_t> next_chunk{first_chunk};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    auto worker = [&]() {
+        try {
+            // Each worker owns its mutable state; the profiles are shared
+            NameGenerator local(*this);
+            for (uint64_t chunk = next_chunk++; chunk < last_chunk; chunk = next_chunk++) {
+                uint64_t begin = std::max<uint64_t>(chunk * kBatchChunkSize, begin_index);
+                uint64_t end = std::min<uint64_t>((chunk + 1) * kBatchChunkSize, end_index);
+                fn(local, chunk, begin, end);
+            }
+        } catch (...) {
+            // Stop the other workers and rethrow on the calling thread
+            next_chunk = last_chunk;
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    };
 
-char NameGenerator::randomLiquid() {
-    // Select a liquid consonant: l, r
-    // These have a "flowing" quality
-    std::uniform_int_distribution<size_t> dist(0, liquids_.size() - 1);
-    return liquids_[dist(rng_)];
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (unsigned t = 1; t < threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
 }
 
-char NameGenerator::randomGlide() {
-    // Select a glide/approximant: w, j (y)
-    // These have a "sliding" quality, like short vowels
-    std::uniform_int_distribution<size_t> dist(0, glides_.size() - 1);
-    return glides_[dist(rng_)];
+std::vector<std::string> NameGenerator::generateBatch(size_t count, unsigned threads) const {
+    std::vector<std::string> names(count);
+    forEachChunk(0, count, threads,
+                 [this, &names](NameGenerator& local, uint64_t, uint64_t begin, uint64_t end) {
+        for (uint64_t i = begin; i < end; ++i) {
+            names[i] = local.generateAt(seed_, i);
+        }
+    });
+    return names;
 }
 
-char NameGenerator::randomVowel() {
-    // Select any vowel: a, e, i, o, u
-    std::uniform_int_distribution<size_t> dist(0, vowels_.size() - 1);
-    return vowels_[dist(rng_)];
+std::vector<NameWithPattern> NameGenerator::generateWithPatternBatch(size_t count, unsigned threads) const {
+    std::vector<NameWithPattern> results(count);
+    forEachChunk(0, count, threads,
+                 [this, &results](NameGenerator& local, uint64_t, uint64_t begin, uint64_t end) {
+        for (uint64_t i = begin; i < end; ++i) {
+            local.rng_.seedStream(seed_, i);
+            results[i] = local.generateWithPattern();
+        }
+    });
+    return results;
 }
 
-char NameGenerator::randomSpecial() {
-    // Select a special ending character: x, z, k
-    // These give names a modern/tech feel
-    std::uniform_int_distribution<size_t> dist(0, special_endings_.size() - 1);
-    return special_endings_[dist(rng_)];
-}
+void NameGenerator::generateStream(uint64_t count, const StreamOptions& options,
+                                   const std::function<void(std::string_view)>& sink) const {
+    const unsigned threads = resolveThreadCount(options.threads);
 
-std::string NameGenerator::randomBlend() {
-    // Select a pre-defined consonant blend: sh, tr, bl, etc.
-    // These are known natural-sounding consonant pairs
-    std::uniform_int_distribution<size_t> dist(0, consonant_blends_.size() - 1);
-    return consonant_blends_[dist(rng_)];
-}
+    // Without uniqueness every name is final. With it, names are candidates
+    // and we keep drawing until enough distinct names were kept.
+    const uint64_t candidate_limit = options.unique ? UINT64_MAX : count;
+    std::unique_ptr<UniqueNameSet> seen;
+    if (options.unique) {
+        seen = std::make_unique<UniqueNameSet>(count);
+    }
 
-std::string NameGenerator::randomQualityPair() {
-    // Generate a "quality pair" - two consonants from different phonetic categories
-    // This avoids problematic clusters like "kt", "pb", "mg" (plosive + plosive)
-    // and creates natural-sounding combinations like "sl", "fr", "mn"
+    std::shared_ptr<const MarkovBatchSampler> batch_sampler;
+    if (options.bulk) {
+        batch_sampler = makeBatchSampler();
+    }
 
-    // Define valid pairing strategies (consonant categories that sound good together)
-    enum class PairType {
-        PlosiveLiquid,     // p+l: pl, tr, kr, bl, dr, gl
-        PlosiveFricative,  // p+f: ps, kf, ts
-        FricativeLiquid,   // f+l: fl, sl, fr, sr
-        FricativeNasal,    // f+n: fn, sn, zm
-        LiquidPlosive,     // l+p: lk, rt, ld
-        LiquidFricative,   // l+f: lf, ls, rv, rz
-        NasalPlosive,      // n+p: mp, nt, nd, nk
-        NasalFricative,    // n+f: nf, ns, nz
-        GlidePlosive,      // w+p: wt, wd (rare but valid)
-        GlideFricative     // w+f: wh-like, ws
+    // Formatted chunk text; with uniqueness also where each line ends and
+    // the fingerprint of its name, computed by the workers
+    struct ChunkText {
+        std::string text;
+        std::vector<uint32_t> line_ends;
+        std::vector<uint64_t> fingerprints;
     };
 
-    // Randomly select a pairing strategy
-    std::uniform_int_distribution<int> strategy_dist(0, 9);
-    PairType strategy = static_cast<PairType>(strategy_dist(rng_));
-
-    std::string pair;
-
-    switch (strategy) {
-        case PairType::PlosiveLiquid:
-            // Plosive + Liquid: very common, sounds great (black, tree, play, grow)
-            pair += randomPlosive();
-            pair += randomLiquid();
-            break;
-
-        case PairType::PlosiveFricative:
-            // Plosive + Fricative: less common but valid (pseudo, gnostic)
-            pair += randomPlosive();
-            pair += randomFricative();
-            break;
-
-        case PairType::FricativeLiquid:
-            // Fricative + Liquid: very natural (flow, slide, shred)
-            pair += randomFricative();
-            pair += randomLiquid();
-            break;
-
-        case PairType::FricativeNasal:
-            // Fricative + Nasal: less common (snack, smack via blends)
-            pair += randomFricative();
-            pair += randomNasal();
-            break;
-
-        case PairType::LiquidPlosive:
-            // Liquid + Plosive: natural (old, art, help)
-            pair += randomLiquid();
-            pair += randomPlosive();
-            break;
-
-        case PairType::LiquidFricative:
-            // Liquid + Fricative: common (also, mars, elf)
-            pair += randomLiquid();
-            pair += randomFricative();
-            break;
-
-        case PairType::NasalPlosive:
-            // Nasal + Plosive: very natural (lamp, hand, link)
-            pair += randomNasal();
-            pair += randomPlosive();
-            break;
-
-        case PairType::NasalFricative:
-            // Nasal + Fricative: works well (ounce, tense)
-            pair += randomNasal();
-            pair += randomFricative();
-            break;
+    // Enough chunks per round to keep every worker busy, few enough that the
+    // text buffers stay small; the buffers are reused across rounds
+    const uint64_t round_size = static_cast<uint64_t>(threads) * 4;
+    std::vector<ChunkText> slots(round_size);
+
+    // Duplicate tracking over a window of recent candidates
+    constexpr uint64_t kWindow = 1 << 18;
+    uint64_t window_candidates = 0;
+    uint64_t window_kept = 0;
+    bool warned = false;
+
+    uint64_t produced = 0;
+    for (uint64_t cursor = 0; cursor < candidate_limit && produced < count;) {
+        // A round ends at a chunk boundary at most round_size chunks on
+        const uint64_t first = cursor / kBatchChunkSize;
+        uint64_t round_end = std::min(candidate_limit, (first + round_size) * kBatchChunkSize);
+        if (options.unique) {
+            // Draw about as many candidates as the names still missing need
+            // at the duplicate rate so far, so small requests stay small.
+            // Bulk chunks share one stream, so they are only drawn whole.
+            const uint64_t remaining = count - produced;
+            const double per_name = static_cast<double>(cursor + 1) / static_cast<double>(produced + 1);
+            const uint64_t expected = static_cast<uint64_t>(std::min(remaining * per_name, 1e18));
+            uint64_t budget = expected + expected / 4 + 16;
+            if (batch_sampler) {
+                budget = chunkCount(budget) * kBatchChunkSize;
+            }
+            round_end = std::min(round_end, cursor + budget);
+        }
+        const uint64_t round_begin = cursor;
+        cursor = round_end;
+
+        forEachChunk(round_begin, round_end, threads,
+                     [&](NameGenerator& local, uint64_t chunk, uint64_t begin, uint64_t end) {
+            Stats::ScopedTimer timer(Stats::StreamChunk);
+            ChunkText& slot = slots[chunk - first];
+            slot.text.clear();
+            slot.line_ends.clear();
+            slot.fingerprints.clear();
+
+            // Names go straight into the chunk text; no per-name strings
+            auto finish_line = [&slot, &options](size_t name_begin, std::string_view pattern) {
+                const size_t name_end = slot.text.size();
+                if (options.with_pattern) {
+                    slot.text += " [";
+                    slot.text += pattern;
+                    slot.text += ']';
+                }
+                slot.text += '\n';
 
-        case PairType::GlidePlosive:
-            // Glide + Plosive: less common but pronounceable
-            pair += randomGlide();
-            pair += randomPlosive();
-            break;
+                if (options.unique) {
+                    slot.line_ends.push_back(static_cast<uint32_t>(slot.text.size()));
+                    slot.fingerprints.push_back(UniqueNameSet::fingerprint(
+                        std::string_view(slot.text).substr(name_begin, name_end - name_begin)));
+                }
+            };
+
+            if (batch_sampler) {
+                // Lanes share one stream per chunk, so bulk names aren't seekable
+                Stats::count(Stats::BulkNames, end - begin);
+                local.rng_.seedStream(seed_, chunk);
+                batch_sampler->generate(end - begin, local.rng_, [&](std::string_view name) {
+                    const size_t name_begin = slot.text.size();
+                    slot.text += name;
+                    finish_line(name_begin, strategyName(strategy_));
+                });
+                return;
+            }
+
+            for (uint64_t i = begin; i < end; ++i) {
+                const size_t name_begin = slot.text.size();
+                local.rng_.seedStream(seed_, options.first_index + i);
+                std::string_view pattern;
+                if (options.with_pattern) {
+                    pattern = local.generateWithPatternInto(slot.text);
+                } else {
+                    local.generateInto(slot.text);
+                }
+                finish_line(name_begin, pattern);
+            }
+        });
 
-        case PairType::GlideFricative:
-            // Glide + Fricative: natural (wish, yes)
-            pair += randomGlide();
-            pair += randomFricative();
-            break;
+        // Emit in chunk order so output doesn't depend on scheduling
+        for (uint64_t chunk = first; chunk < chunkCount(round_end) && produced < count; ++chunk) {
+            const ChunkText& slot = slots[chunk - first];
+            if (!options.unique) {
+                sink(slot.text);
+                produced = std::min<uint64_t>((chunk + 1) * kBatchChunkSize, count);
+                continue;
+            }
+
+            // Keep first occurrences only, emitting runs of kept lines at once
+            std::string_view text = slot.text;
+            size_t run_begin = 0;
+            size_t line_begin = 0;
+            for (size_t n = 0; n < slot.line_ends.size() && produced < count; ++n) {
+                size_t line_end = slot.line_ends[n];
+                if (seen->insert(slot.fingerprints[n])) {
+                    ++produced;
+                    ++window_kept;
+                } else {
+                    Stats::count(Stats::UniqueDuplicates);
+                    if (line_begin > run_begin) {
+                        sink(text.substr(run_begin, line_begin - run_begin));
+                    }
+                    run_begin = line_end;
+                }
+                line_begin = line_end;
+                ++window_candidates;
+            }
+            if (line_begin > run_begin) {
+                sink(text.substr(run_begin, line_begin - run_begin));
+            }
+
+            // Judge how close the profile's name space is to exhaustion
+            if (window_candidates >= kWindow) {
+                double duplicate_rate = 1.0 - static_cast<double>(window_kept) / window_candidates;
+                if (window_kept * 1000 < window_candidates) {
+                    throw std::runtime_error("Name space exhausted: only " + std::to_string(produced) +
+                                             " distinct names found (" + std::to_string(count) + " requested)");
+                }
+                if (duplicate_rate > 0.5 && !warned) {
+                    std::cerr << "Warning: " << static_cast<int>(duplicate_rate * 100)
+                              << "% of recent names were duplicates; the profile's name space is nearly exhausted\n";
+                    warned = true;
+                }
+                window_candidates = 0;
+                window_kept = 0;
+            }
+        }
     }
-
-    return pair;
-}
-
-// ===== PATTERN ELEMENT GENERATORS =====
-// These functions generate pattern elements based on the pattern code
-// They are called by generateFromPattern() for each character in the pattern
-
-std::string NameGenerator::generateC() {
-    // C = any Consonant
-    return std::string(1, randomConsonant());
-}
-
-std::string NameGenerator::generateP() {
-    // P = Plosive/stop consonant (b, c, d, g, k, p, q, t)
-    // Percussive sounds - air is blocked then released
-    return std::string(1, randomPlosive());
-}
-
-std::string NameGenerator::generateF() {
-    // F = Fricative consonant (f, h, s, v, x, z)
-    // Breathy sounds - air forced through narrow gap
-    return std::string(1, randomFricative());
-}
-
-std::string NameGenerator::generateN() {
-    // N = Nasal consonant (m, n)
-    // Humming sounds - air flows through nose
-    return std::string(1, randomNasal());
-}
-
-std::string NameGenerator::generateL() {
-    // L = Liquid consonant (l, r)
-    // Flowing sounds
-    return std::string(1, randomLiquid());
-}
-
-std::string NameGenerator::generateW() {
-    // W = Glide (w, j/y)
-    // Sliding sounds, like short vowels
-    return std::string(1, randomGlide());
 }
 
-std::string NameGenerator::generateV() {
-    // V = Vowel (a, e, i, o, u)
-    return std::string(1, randomVowel());
-}
-
-std::string NameGenerator::generateB() {
-    // B = pre-defined Blend (sh, tr, bl, etc.)
-    // These are known natural-sounding consonant combinations
-    return randomBlend();
-}
-
-std::string NameGenerator::generateD() {
-    // D = Double letter (same letter repeated)
-    // Can be either a vowel or consonant
-    std::uniform_int_distribution<int> dist(0, 1);
-    char c = dist(rng_) ? randomVowel() : randomConsonant();
-    return std::string(2, c);
-}
+std::shared_ptr<const MarkovBatchSampler> NameGenerator::makeBatchSampler() const {
+    if (!profile_ || profile2_ || exclusions_ || min_length_ > 0 || max_length_ > 0) {
+        return nullptr;
+    }
 
-std::string NameGenerator::generateS() {
-    // S = Special ending (x, z, k)
-    // Gives names a modern/tech feel
-    return std::string(1, randomSpecial());
+    std::shared_ptr<const MarkovBatchSampler> sampler;
+    if (strategy_ == GenerationStrategy::Markov1) {
+        sampler = std::make_shared<const MarkovBatchSampler>(profile_->getMarkovOrder1(), kMaxMarkovLength);
+    } else if (strategy_ == GenerationStrategy::Markov2) {
+        sampler = std::make_shared<const MarkovBatchSampler>(profile_->getMarkovOrder2(), kMaxMarkovLength);
+    }
+    return sampler && sampler->feasible() ? sampler : nullptr;
 }
 
-std::string NameGenerator::generateQ() {
-    // Q = Quality pair - smart consonant pairing from different phonetic categories
-    // Avoids bad clusters like "kt", "pb" and creates natural pairs like "sl", "fr"
-    return randomQualityPair();
+uint64_t NameGenerator::chunkCount(uint64_t count) {
+    return (count + kBatchChunkSize - 1) / kBatchChunkSize;
 }
 
-std::string NameGenerator::generateFromPattern(const std::string& pattern) {
-    // Interpret a pattern string and generate a name
-    // Each character in the pattern is a code that generates specific sounds
-    //
-    // Pattern codes (organized by category):
-    //   BASIC:
-    //     C = any Consonant
-    //     V = Vowel
-    //
-    //   PHONETIC CONSONANTS (organized by how they're pronounced):
-    //     P = Plosive/stop (b,d,g,k,p,t)     - percussive
-    //     F = Fricative (f,h,s,v,x,z)        - breathy
-    //     N = Nasal (m,n)                    - humming
-    //     L = Liquid (l,r)                   - flowing
-    //     W = Glide (w,j)                    - sliding
-    //
-    //   SPECIAL:
-    //     B = pre-defined Blend (sh,tr,bl)   - known good pairs
-    //     Q = Quality pair                   - smart auto-pairing
-    //     D = Double letter                  - repeated character
-    //     S = Special ending (x,z,k)         - modern/tech feel
-
-    std::string result;
-
-    for (char code : pattern) {
-        switch (code) {
-            // Basic codes
-            case 'C':
-                result += generateC();  // Any consonant
-                break;
-            case 'V':
-                result += generateV();  // Vowel
-                break;
-
-            // Phonetic consonant categories
-            case 'P':
-                result += generateP();  // Plosive
-                break;
-            case 'F':
-                result += generateF();  // Fricative
-                break;
-            case 'N':
-                result += generateN();  // Nasal
-                break;
-            case 'L':
-                result += generateL();  // Liquid
-                break;
-            case 'W':
-                result += generateW();  // Glide
-                break;
-
-            // Special codes
-            case 'B':
-                result += generateB();  // Pre-defined blend
-                break;
-            case 'Q':
-                result += generateQ();  // Smart quality pair
-                break;
-            case 'D':
-                result += generateD();  // Double letter
-                break;
-            case 'S':
-                result += generateS();  // Special ending
-                break;
-
-            default:
-                // Unknown pattern code - skip silently
-                // This allows for future extension
-                break;
-        }
-    }
-
-    return capitalize(result);
+void NameGenerator::generateFromPattern(size_t pattern, std::string& out) {
+    // Run the pattern's compiled program straight into the output; the
+    // buffer is sized for the longest pattern, then trimmed to the name
+    const size_t start = out.size();
+    out.resize(start + pattern_program_.bufferSize());
+    size_t length = pattern_program_.emit(pattern, rng_, out.data() + start);
+    out.resize(start + length);
+    capitalize(out, start);
 }
 
-std::string NameGenerator::capitalize(std::string str) {
-    if (!str.empty()) {
-        str[0] = std::toupper(static_cast<unsigned char>(str[0]));
+void NameGenerator::capitalize(std::string& str, size_t start) {
+    if (start < str.size()) {
+        str[start] = static_cast<char>(std::toupper(static_cast<unsigned char>(str[start])));
     }
-    return str;
 }
@@ -0,0 +1,287 @@
+#include "NameMerger.hpp"
+#include "OutputWriter.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+namespace {
+
+constexpr size_t kInputBufferSize = 1 << 20;
+constexpr size_t kRunBufferSize = 64 << 10;  // Per run while merging
+constexpr size_t kMaxMergeWays = 128;        // Runs merged at once (open files)
+
+using File = std::unique_ptr<std::FILE, int (*)(std::FILE*)>;
+
+File openInput(const std::string& path) {
+    File file(std::fopen(path.c_str(), "rb"), &std::fclose);
+    if (!file) {
+        throw std::runtime_error("Failed to open " + path + ": " + std::strerror(errno));
+    }
+    return file;
+}
+
+File openTemporary() {
+    // Removed by the OS once closed
+    File file(std::tmpfile(), &std::fclose);
+    if (!file) {
+        throw std::runtime_error(std::string("Failed to create temporary file: ") + std::strerror(errno));
+    }
+    return file;
+}
+
+// Reads lines from a file through a fixed buffer. The returned view stays
+// valid until the next call.
+class LineReader {
+public:
+    LineReader(std::FILE* file, size_t buffer_size) : file_(file), buffer_(buffer_size) {}
+
+    bool next(std::string_view& line) {
+        if (carried_) {
+            carry_.clear();
+            carried_ = false;
+        }
+        for (;;) {
+            const char* begin = buffer_.data() + position_;
+            const char* end = buffer_.data() + size_;
+            const char* newline = static_cast<const char*>(std::memchr(begin, '\n', static_cast<size_t>(end - begin)));
+            if (newline) {
+                position_ = static_cast<size_t>(newline + 1 - buffer_.data());
+                if (carry_.empty()) {
+                    line = trim(std::string_view(begin, static_cast<size_t>(newline - begin)));
+                    return true;
+                }
+                carry_.append(begin, newline);
+                return takeCarry(line);
+            }
+
+            // Line continues past the buffer
+            carry_.append(begin, end);
+            position_ = 0;
+            size_ = std::fread(buffer_.data(), 1, buffer_.size(), file_);
+            if (size_ == 0) {
+                if (std::ferror(file_)) {
+                    throw std::runtime_error("Read failed while merging");
+                }
+                return !carry_.empty() && takeCarry(line);
+            }
+        }
+    }
+
+private:
+    static std::string_view trim(std::string_view line) {
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        return line;
+    }
+
+    bool takeCarry(std::string_view& line) {
+        carried_ = true;
+        line = trim(carry_);
+        return true;
+    }
+
+    std::FILE* file_;
+    std::vector<char> buffer_;
+    size_t position_ = 0;
+    size_t size_ = 0;
+    std::string carry_;
+    bool carried_ = false;
+};
+
+// Writes sorted lines to a temporary file
+class RunWriter {
+public:
+    RunWriter() : file_(openTemporary()) {}
+
+    void write(std::string_view line) {
+        buffer_.append(line);
+        buffer_ += '\n';
+        if (buffer_.size() >= kInputBufferSize) {
+            flush();
+        }
+    }
+
+    // Rewinds the run for reading
+    File finish() {
+        flush();
+        if (std::fflush(file_.get()) != 0) {
+            throw std::runtime_error("Failed to write temporary file");
+        }
+        std::rewind(file_.get());
+        return std::move(file_);
+    }
+
+private:
+    void flush() {
+        if (std::fwrite(buffer_.data(), 1, buffer_.size(), file_.get()) != buffer_.size()) {
+            throw std::runtime_error("Failed to write temporary file");
+        }
+        buffer_.clear();
+    }
+
+    File file_;
+    std::string buffer_;
+};
+
+// K-way merge of sorted runs, emitting each distinct line once
+template <typename Emit>
+void mergeRuns(const std::vector<File>& runs, Emit&& emit) {
+    std::vector<LineReader> readers;
+    readers.reserve(runs.size());
+
+    using Head = std::pair<std::string_view, size_t>;  // (line, run)
+    auto later = [](const Head& a, const Head& b) { return a.first > b.first; };
+    std::priority_queue<Head, std::vector<Head>, decltype(later)> heads(later);
+
+    std::string_view line;
+    for (size_t i = 0; i < runs.size(); ++i) {
+        readers.emplace_back(runs[i].get(), kRunBufferSize);
+        if (readers[i].next(line)) {
+            heads.push({line, i});
+        }
+    }
+
+    std::string last;
+    bool first = true;
+    while (!heads.empty()) {
+        auto [head, run] = heads.top();
+        heads.pop();
+        if (first || head != last) {
+            emit(head);
+            last.assign(head);
+            first = false;
+        }
+        if (readers[run].next(line)) {
+            heads.push({line, run});
+        }
+    }
+}
+
+} // namespace
+
+NameMerger::NameMerger(size_t memory_budget) : memory_budget_(memory_budget) {
+}
+
+uint64_t NameMerger::concatenate(const std::vector<std::string>& inputs, OutputWriter& out) const {
+    std::vector<char> buffer(kInputBufferSize);
+    uint64_t lines = 0;
+
+    for (const std::string& path : inputs) {
+        File file = openInput(path);
+        bool ends_with_newline = true;
+        size_t read;
+        while ((read = std::fread(buffer.data(), 1, buffer.size(), file.get())) > 0) {
+            out.write(std::string_view(buffer.data(), read));
+            lines += static_cast<uint64_t>(std::count(buffer.data(), buffer.data() + read, '\n'));
+            ends_with_newline = buffer[read - 1] == '\n';
+        }
+        if (std::ferror(file.get())) {
+            throw std::runtime_error("Failed to read " + path);
+        }
+        if (!ends_with_newline) {
+            out.write("\n");
+            ++lines;
+        }
+    }
+    return lines;
+}
+
+uint64_t NameMerger::mergeUnique(const std::vector<std::string>& inputs, OutputWriter& out) const {
+    // Lines are packed into one arena and sorted by (offset, length) pairs;
+    // a third of the budget holds text and the rest the index, which
+    // dominates for short names
+    struct Line {
+        uint64_t offset;
+        uint64_t length;
+    };
+    size_t arena_capacity = std::max<size_t>(memory_budget_ / 3, 1 << 16);
+    size_t max_lines = std::max<size_t>((memory_budget_ - memory_budget_ / 3) / sizeof(Line), 1 << 12);
+
+    std::string arena;
+    std::vector<Line> lines;
+    arena.reserve(arena_capacity);
+    lines.reserve(max_lines);
+
+    auto text = [&arena](const Line& line) {
+        return std::string_view(arena.data() + line.offset, line.length);
+    };
+    auto sortLines = [&]() {
+        std::sort(lines.begin(), lines.end(), [&](const Line& a, const Line& b) { return text(a) < text(b); });
+    };
+    // Each distinct line of the sorted arena, once
+    auto forEachDistinct = [&](auto&& emit) {
+        for (size_t i = 0; i < lines.size(); ++i) {
+            if (i == 0 || text(lines[i]) != text(lines[i - 1])) {
+                emit(text(lines[i]));
+            }
+        }
+    };
+
+    std::vector<File> runs;
+    auto spill = [&]() {
+        sortLines();
+        RunWriter run;
+        forEachDistinct([&run](std::string_view line) { run.write(line); });
+        runs.push_back(run.finish());
+        arena.clear();
+        lines.clear();
+    };
+
+    std::string_view line;
+    for (const std::string& path : inputs) {
+        File file = openInput(path);
+        LineReader reader(file.get(), kInputBufferSize);
+        while (reader.next(line)) {
+            if (line.empty()) {
+                continue;
+            }
+            if (!lines.empty() && (arena.size() + line.size() > arena_capacity || lines.size() == max_lines)) {
+                spill();
+            }
+            lines.push_back({arena.size(), line.size()});
+            arena.append(line);
+        }
+    }
+
+    uint64_t written = 0;
+    auto emit = [&out, &written](std::string_view name) {
+        out.write(name);
+        out.write("\n");
+        ++written;
+    };
+
+    // Everything fit in memory: no temporary files
+    if (runs.empty()) {
+        sortLines();
+        forEachDistinct(emit);
+        return written;
+    }
+    if (!lines.empty()) {
+        spill();
+    }
+    std::string().swap(arena);
+    std::vector<Line>().swap(lines);
+
+    // Too many runs to open at once: merge them in groups first
+    while (runs.size() > kMaxMergeWays) {
+        std::vector<File> group;
+        for (size_t i = 0; i < kMaxMergeWays; ++i) {
+            group.push_back(std::move(runs[i]));
+        }
+        runs.erase(runs.begin(), runs.begin() + kMaxMergeWays);
+
+        RunWriter merged;
+        mergeRuns(group, [&merged](std::string_view name) { merged.write(name); });
+        runs.push_back(merged.finish());
+    }
+
+    mergeRuns(runs, emit);
+    return written;
+}
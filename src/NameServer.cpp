@@ -0,0 +1,495 @@
+#include "NameServer.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include "Stats.hpp"
+
+#ifndef _WIN32
+#include <csignal>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Requests from one connection that may be generating at once; bounds the
+// memory held by responses waiting for their turn
+constexpr size_t kMaxPipelined = 64;
+
+std::vector<std::string_view> splitWords(std::string_view line) {
+    std::vector<std::string_view> words;
+    size_t pos = 0;
+    while (pos < line.size()) {
+        size_t begin = line.find_first_not_of(" \t", pos);
+        if (begin == std::string_view::npos) {
+            break;
+        }
+        size_t end = line.find_first_of(" \t", begin);
+        if (end == std::string_view::npos) {
+            end = line.size();
+        }
+        words.push_back(line.substr(begin, end - begin));
+        pos = end;
+    }
+    return words;
+}
+
+template <typename T>
+bool parseNumber(std::string_view text, T& value) {
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc() && end == text.data() + text.size();
+}
+
+std::string errorResponse(std::string_view message) {
+    std::string response = "ERR ";
+    response.append(message);
+    response += '\n';
+    return response;
+}
+
+#ifndef _WIN32
+// Write all of text to a socket; false once the peer is gone
+bool sendAll(int fd, std::string_view text) {
+    const char* data = text.data();
+    size_t remaining = text.size();
+    while (remaining > 0) {
+        ssize_t written = ::write(fd, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        remaining -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+int listenUnix(const std::string& path) {
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path is too long: " + path);
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    // Replace a socket left behind by an earlier run, but nothing else
+    struct stat info;
+    if (::stat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+        ::unlink(path.c_str());
+    }
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error(std::string("Failed to create socket: ") + std::strerror(errno));
+    }
+    if (::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(fd, SOMAXCONN) != 0) {
+        std::string error = std::strerror(errno);
+        ::close(fd);
+        throw std::runtime_error("Failed to listen on " + path + " (" + error + ")");
+    }
+    return fd;
+}
+
+int listenTcp(uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error(std::string("Failed to create socket: ") + std::strerror(errno));
+    }
+    int enable = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    // Localhost only: the protocol has no authentication
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(fd, SOMAXCONN) != 0) {
+        std::string error = std::strerror(errno);
+        ::close(fd);
+        throw std::runtime_error("Failed to listen on port " + std::to_string(port) + " (" + error + ")");
+    }
+    return fd;
+}
+#endif
+
+} // namespace
+
+NameServer::WorkerPool::WorkerPool(unsigned threads) {
+    for (unsigned i = 0; i < threads; ++i) {
+        workers_.emplace_back([this] {
+            for (;;) {
+                std::function<void()> job;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    ready_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+                    if (jobs_.empty()) {
+                        return;
+                    }
+                    job = std::move(jobs_.front());
+                    jobs_.pop_front();
+                }
+                job();
+            }
+        });
+    }
+}
+
+NameServer::WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    ready_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+void NameServer::WorkerPool::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(std::move(job));
+    }
+    ready_.notify_one();
+}
+
+NameServer::NameServer(ServerOptions options)
+    : options_(std::move(options)), profiles_(options_.memory_budget), next_seed_(std::random_device{}()) {
+    unsigned threads = options_.threads;
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    pool_ = std::make_unique<WorkerPool>(threads);
+}
+
+NameServer::~NameServer() {
+    if (watcher_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(watch_mutex_);
+            stopping_ = true;
+        }
+        watch_wake_.notify_all();
+        watcher_.join();
+    }
+}
+
+void NameServer::addProfile(const std::string& name, const std::string& path) {
+    profiles_.add(name, path);
+}
+
+size_t NameServer::addProfileDirectory(const std::string& directory) {
+    return profiles_.addDirectory(directory);
+}
+
+std::string NameServer::handleRequest(std::string_view line) {
+    Stats::ScopedTimer timer(Stats::ServeRequest);
+    Stats::count(Stats::ServeRequests);
+    std::string response = answer(line);
+    if (response.starts_with("ERR ")) {
+        Stats::count(Stats::ServeErrors);
+    }
+    return response;
+}
+
+std::string NameServer::answer(std::string_view line) {
+    std::vector<std::string_view> words = splitWords(line);
+    if (words.empty()) {
+        return errorResponse("empty request");
+    }
+
+    try {
+        if (words[0] == "GEN") {
+            return generate(words);
+        }
+        if (words[0] == "PING" && words.size() == 1) {
+            return "PONG\n";
+        }
+        if (words[0] == "RELOAD" && words.size() <= 2) {
+            std::vector<std::string> names = reloadProfiles(words.size() == 2 ? words[1] : std::string_view());
+            std::string response = "OK " + std::to_string(names.size()) + '\n';
+            for (const std::string& name : names) {
+                response += name;
+                response += '\n';
+            }
+            return response;
+        }
+        if (words[0] == "STATS" && words.size() == 1) {
+            return "OK 1\n" + Stats::toJson() + '\n';
+        }
+        if (words[0] == "PROFILES" && words.size() == 1) {
+            std::vector<std::string> names = profiles_.names();
+            std::string response = "OK " + std::to_string(names.size()) + '\n';
+            for (const std::string& name : names) {
+                response += name;
+                response += '\n';
+            }
+            return response;
+        }
+    } catch (const std::exception& e) {
+        return errorResponse(e.what());
+    }
+    return errorResponse("unknown command '" + std::string(words[0]) + "'");
+}
+
+std::string NameServer::generate(const std::vector<std::string_view>& words) {
+    uint64_t count = 0;
+    if (words.size() < 2 || !parseNumber(words[1], count) || count == 0) {
+        return errorResponse("GEN needs a name count");
+    }
+    if (count > kMaxRequestNames) {
+        return errorResponse("at most " + std::to_string(kMaxRequestNames) + " names per request");
+    }
+
+    NameGenerator generator = prototype_;
+    generator.seed(next_seed_.fetch_add(1, std::memory_order_relaxed));
+    std::shared_ptr<const ProfileData> profile;
+    std::shared_ptr<const ProfileData> profile2;
+    GenerationStrategy strategy = GenerationStrategy::Markov2;
+    size_t min_length = 0;
+    size_t max_length = 0;
+    StreamOptions options;
+
+    for (size_t i = 2; i < words.size(); ++i) {
+        size_t equals = words[i].find('=');
+        if (equals == std::string_view::npos) {
+            return errorResponse("expected key=value, got '" + std::string(words[i]) + "'");
+        }
+        std::string_view key = words[i].substr(0, equals);
+        std::string_view value = words[i].substr(equals + 1);
+
+        bool valid = true;
+        if (key == "profile" || key == "profile2") {
+            if (!profiles_.contains(value)) {
+                return errorResponse("unknown profile '" + std::string(value) + "'");
+            }
+            (key == "profile" ? profile : profile2) = profiles_.get(value);
+        } else if (key == "blend") {
+            profile = blendProfile(value);
+        } else if (key == "strategy") {
+            valid = NameGenerator::parseStrategy(value, strategy);
+        } else if (key == "min") {
+            valid = parseNumber(value, min_length);
+        } else if (key == "max") {
+            valid = parseNumber(value, max_length);
+        } else if (key == "seed") {
+            uint64_t seed = 0;
+            valid = parseNumber(value, seed);
+            generator.seed(seed);
+        } else if (key == "start") {
+            valid = parseNumber(value, options.first_index);
+        } else if (key == "unique") {
+            valid = value == "0" || value == "1";
+            options.unique = value == "1";
+        } else {
+            return errorResponse("unknown option '" + std::string(key) + "'");
+        }
+        if (!valid) {
+            return errorResponse("invalid " + std::string(key) + " '" + std::string(value) + "'");
+        }
+    }
+
+    // Without a profile the generator uses its legacy patterns
+    if (profile) {
+        generator.setProfile(std::move(profile));
+        generator.setSecondProfile(std::move(profile2));
+        generator.setStrategy(strategy);
+        generator.setMinLength(min_length);
+        generator.setMaxLength(max_length);
+    } else if (profile2) {
+        return errorResponse("profile2 requires profile");
+    }
+
+    std::string response = "OK " + std::to_string(count) + '\n';
+    generator.generateStream(count, options, [&response](std::string_view text) {
+        response.append(text);
+    });
+    return response;
+}
+
+std::vector<std::string> NameServer::reloadProfiles(std::string_view name) {
+    std::vector<std::string> reloaded;
+    std::vector<std::string> errors;
+    if (name.empty()) {
+        reloaded = profiles_.reloadChanged(&errors);
+    } else {
+        if (!profiles_.contains(name)) {
+            throw std::runtime_error("unknown profile '" + std::string(name) + "'");
+        }
+        if (profiles_.reload(name)) {
+            reloaded.emplace_back(name);
+        }
+    }
+
+    for (const std::string& error : errors) {
+        std::cerr << "Error reloading profile " << error << '\n';
+    }
+    if (!reloaded.empty()) {
+        // Blends mix the old versions; build them again on next use
+        std::lock_guard<std::mutex> lock(blends_mutex_);
+        blends_.clear();
+        ++blends_generation_;
+    }
+    return reloaded;
+}
+
+void NameServer::watchProfiles() {
+    std::unique_lock<std::mutex> lock(watch_mutex_);
+    while (!watch_wake_.wait_for(lock, std::chrono::seconds(options_.reload_interval), [this] { return stopping_; })) {
+        lock.unlock();
+        for (const std::string& name : reloadProfiles({})) {
+            std::cerr << "Reloaded profile " << name << '\n';
+        }
+        lock.lock();
+    }
+}
+
+std::shared_ptr<const ProfileData> NameServer::blendProfile(std::string_view spec) {
+    for (;;) {
+        uint64_t generation;
+        {
+            std::lock_guard<std::mutex> lock(blends_mutex_);
+            auto it = blends_.find(spec);
+            if (it != blends_.end()) {
+                return it->second;
+            }
+            generation = blends_generation_;
+        }
+
+        // Mix outside the lock; two requests racing on a new spec both mix it
+        std::vector<ProfileData::BlendComponent> components;
+        for (const auto& [name, weight] : ProfileData::parseBlendSpec(spec)) {
+            components.push_back({profiles_.get(name), weight});
+        }
+        std::shared_ptr<const ProfileData> blended = ProfileData::blend(components);
+
+        std::lock_guard<std::mutex> lock(blends_mutex_);
+        if (generation != blends_generation_) {
+            // A reload ran while mixing, so some parts may be old versions
+            continue;
+        }
+        if (blends_.size() >= kMaxCachedBlends) {
+            blends_.clear();
+        }
+        blends_.emplace(std::string(spec), blended);
+        return blended;
+    }
+}
+
+#ifdef _WIN32
+
+void NameServer::run() {
+    throw std::runtime_error("serve mode is not supported on Windows");
+}
+
+void NameServer::serveConnection(int) {
+}
+
+#else
+
+void NameServer::run() {
+    // A client hanging up mid-response must not kill the server
+    std::signal(SIGPIPE, SIG_IGN);
+
+    int listener = options_.socket_path.empty() ? listenTcp(options_.port) : listenUnix(options_.socket_path);
+    if (options_.reload_interval > 0 && !watcher_.joinable()) {
+        watcher_ = std::thread(&NameServer::watchProfiles, this);
+    }
+    for (;;) {
+        int fd = ::accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            std::string error = std::strerror(errno);
+            ::close(listener);
+            throw std::runtime_error("accept failed: " + error);
+        }
+        if (options_.socket_path.empty()) {
+            int enable = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        }
+        // One reader per connection; the generation runs on the pool
+        std::thread(&NameServer::serveConnection, this, fd).detach();
+    }
+}
+
+void NameServer::serveConnection(int fd) {
+    std::string input;
+    std::deque<std::future<std::string>> pending;
+    char chunk[65536];
+
+    // Send finished responses in request order until at most `keep` remain
+    auto drain = [&](size_t keep) {
+        while (pending.size() > keep) {
+            std::string response = pending.front().get();
+            pending.pop_front();
+            if (!sendAll(fd, response)) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    bool open = true;
+    while (open) {
+        ssize_t received = ::read(fd, chunk, sizeof(chunk));
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            break;
+        }
+        input.append(chunk, static_cast<size_t>(received));
+
+        // Queue every complete line; they generate in parallel
+        size_t line_begin = 0;
+        for (size_t newline; (newline = input.find('\n', line_begin)) != std::string::npos;
+             line_begin = newline + 1) {
+            std::string line = input.substr(line_begin, newline - line_begin);
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            auto task = std::make_shared<std::packaged_task<std::string()>>(
+                [this, line = std::move(line)] { return handleRequest(line); });
+            pending.push_back(task->get_future());
+            pool_->submit([task] { (*task)(); });
+            if (!drain(kMaxPipelined - 1)) {
+                open = false;
+                break;
+            }
+        }
+        input.erase(0, line_begin);
+        if (input.size() > kMaxLineLength) {
+            drain(0);
+            sendAll(fd, errorResponse("request line too long"));
+            break;
+        }
+
+        // Answer everything received so far before blocking on the next read
+        if (open && !drain(0)) {
+            break;
+        }
+    }
+
+    // Let queued jobs finish before their results are dropped
+    for (std::future<std::string>& response : pending) {
+        response.wait();
+    }
+    ::close(fd);
+}
+
+#endif
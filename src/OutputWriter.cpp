@@ -0,0 +1,72 @@
+#include "OutputWriter.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define NAMEGEN_WRITE ::_write
+#define NAMEGEN_CLOSE ::_close
+#define NAMEGEN_OPEN(path) ::_open(path, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, 0644)
+#else
+#include <unistd.h>
+#define NAMEGEN_WRITE ::write
+#define NAMEGEN_CLOSE ::close
+#define NAMEGEN_OPEN(path) ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644)
+#endif
+
+OutputWriter::OutputWriter(int fd, size_t buffer_size)
+    : fd_(fd), capacity_(buffer_size) {
+    buffer_.reserve(capacity_);
+}
+
+OutputWriter::OutputWriter(const std::string& path, size_t buffer_size)
+    : fd_(NAMEGEN_OPEN(path.c_str())), owns_fd_(true), capacity_(buffer_size) {
+    if (fd_ < 0) {
+        throw std::runtime_error("Failed to open output file: " + path + " (" + std::strerror(errno) + ")");
+    }
+    buffer_.reserve(capacity_);
+}
+
+OutputWriter::~OutputWriter() {
+    // Destructors can't report errors; callers wanting them flush() first
+    try {
+        flush();
+    } catch (const std::exception&) {
+    }
+    if (owns_fd_) {
+        NAMEGEN_CLOSE(fd_);
+    }
+}
+
+void OutputWriter::flush() {
+    if (!buffer_.empty()) {
+        // Drop the text even if the write throws, so the destructor doesn't retry
+        try {
+            writeAll(buffer_);
+        } catch (...) {
+            buffer_.clear();
+            throw;
+        }
+        buffer_.clear();  // Keeps capacity for reuse
+    }
+}
+
+void OutputWriter::writeAll(std::string_view text) {
+    const char* data = text.data();
+    size_t remaining = text.size();
+
+    while (remaining > 0) {
+        auto written = NAMEGEN_WRITE(fd_, data, static_cast<unsigned>(std::min<size_t>(remaining, 1u << 30)));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("Write failed: ") + std::strerror(errno));
+        }
+        data += written;
+        remaining -= static_cast<size_t>(written);
+    }
+}
@@ -0,0 +1,70 @@
+#include "PatternProgram.hpp"
+#include <algorithm>
+#include <limits>
+#include <span>
+#include <stdexcept>
+
+PatternProgram::PatternProgram(const std::vector<std::string>& patterns,
+                               const std::map<char, Alternatives>& codes) {
+    // One table per code, laid out back to back
+    std::map<char, uint8_t> table_for_code;
+    std::vector<size_t> max_piece_length;
+    for (const auto& [code, alternatives] : codes) {
+        if (alternatives.empty()) {
+            continue;
+        }
+
+        Table table;
+        table.first = static_cast<uint32_t>(pieces_.size());
+        std::vector<uint64_t> weights;
+        size_t longest = 0;
+        for (const auto& [text, weight] : alternatives) {
+            if (text.size() > kMaxPieceLength) {
+                throw std::runtime_error("Pattern piece too long: " + text);
+            }
+            Piece piece = {};
+            std::copy(text.begin(), text.end(), piece.text);
+            piece.length = static_cast<uint8_t>(text.size());
+            pieces_.push_back(piece);
+            weights.push_back(weight);
+            longest = std::max(longest, text.size());
+        }
+
+        threshold_.resize(pieces_.size());
+        alias_.resize(pieces_.size());
+        uint64_t total = AliasTable::build(weights, std::span(threshold_).subspan(table.first),
+                                           std::span(alias_).subspan(table.first));
+        uint64_t range = total * weights.size();
+        if (total == 0 || range > std::numeric_limits<uint32_t>::max()) {
+            throw std::runtime_error(std::string("Invalid weights for pattern code ") + code);
+        }
+        bool uniform = std::all_of(weights.begin(), weights.end(),
+                                   [&weights](uint64_t weight) { return weight == weights.front(); });
+        table.range = uniform ? static_cast<uint32_t>(weights.size()) : static_cast<uint32_t>(range);
+        table.total = uniform ? 0 : static_cast<uint32_t>(total);
+
+        table_for_code[code] = static_cast<uint8_t>(tables_.size());
+        tables_.push_back(table);
+        max_piece_length.push_back(longest);
+    }
+
+    size_t longest_name = 0;
+    for (const auto& pattern : patterns) {
+        Program program;
+        program.begin = static_cast<uint32_t>(ops_.size());
+        size_t max_length = 0;
+        for (char code : pattern) {
+            auto it = table_for_code.find(code);
+            if (it == table_for_code.end()) {
+                continue;
+            }
+            ops_.push_back(it->second);
+            max_length += max_piece_length[it->second];
+        }
+        program.end = static_cast<uint32_t>(ops_.size());
+        programs_.push_back(program);
+        longest_name = std::max(longest_name, max_length);
+    }
+
+    buffer_size_ = longest_name + kMaxPieceLength;
+}
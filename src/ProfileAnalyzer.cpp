@@ -0,0 +1,412 @@
+#include "ProfileAnalyzer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+#include "NameEnumerator.hpp"
+
+namespace {
+
+// Path probabilities are histogrammed by surprisal: bucket b holds paths
+// with -log2(p) in [b / kBucketsPerBit, (b + 1) / kBucketsPerBit). Paths
+// rarer than 2^-96 share the last bucket; they only matter for draw counts
+// far beyond anything that can be generated.
+constexpr int kBucketsPerBit = 4;
+constexpr size_t kBuckets = 96 * kBucketsPerBit;
+
+// Start syllables per work item of the syllable enumeration
+constexpr size_t kStartsPerChunk = 64;
+
+size_t bucketOf(double surprisal) {
+    double bucket = std::floor(surprisal * kBucketsPerBit);
+    if (!(bucket > 0.0)) {
+        return 0;
+    }
+    return bucket >= static_cast<double>(kBuckets - 1) ? kBuckets - 1 : static_cast<size_t>(bucket);
+}
+
+struct Bounds {
+    size_t min_length;
+    size_t max_length;
+
+    bool contains(size_t length) const {
+        return length >= min_length && (max_length == 0 || length <= max_length);
+    }
+};
+
+// Where walks end: mass and surprisal per length, plus the probability
+// histogram of the names inside the bounds
+struct Terminals {
+    std::vector<double> mass;         // [length]
+    std::vector<double> surprisal;    // [length]: sum of p * -log2(p)
+    std::vector<double> count;        // [bucket]: names
+    std::vector<double> bucket_mass;  // [bucket]: their total probability
+
+    Terminals() : count(kBuckets), bucket_mass(kBuckets) {}
+
+    void addLength(size_t length, double probability, double weighted_surprisal) {
+        if (length >= mass.size()) {
+            mass.resize(length + 1);
+            surprisal.resize(length + 1);
+        }
+        mass[length] += probability;
+        surprisal[length] += weighted_surprisal;
+    }
+
+    void merge(const Terminals& other) {
+        for (size_t length = 0; length < other.mass.size(); ++length) {
+            addLength(length, other.mass[length], other.surprisal[length]);
+        }
+        for (size_t b = 0; b < kBuckets; ++b) {
+            count[b] += other.count[b];
+            bucket_mass[b] += other.bucket_mass[b];
+        }
+    }
+};
+
+unsigned resolveThreads(unsigned threads) {
+    return threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads;
+}
+
+// Run fn(begin, end) over [0, n) split into one contiguous block per thread
+template <typename Fn>
+void parallelFor(size_t n, unsigned threads, Fn fn) {
+    threads = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(n / 64, 1)));
+    if (threads <= 1) {
+        fn(size_t(0), n);
+        return;
+    }
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back(fn, n * t / threads, n * (t + 1) / threads);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+// Paths of one length, per Markov state
+struct Level {
+    std::vector<double> mass;         // [state]
+    std::vector<double> surprisal;    // [state]: sum of p * -log2(p)
+    std::vector<double> count;        // [state * kBuckets + bucket]: paths
+    std::vector<double> bucket_mass;  // [state * kBuckets + bucket]: their probability
+    std::vector<double> mean;         // [state * kBuckets + bucket]: -log2 of their mean probability
+    std::vector<uint32_t> low;        // [state]: buckets in use are [low, high)
+    std::vector<uint32_t> high;
+
+    explicit Level(uint32_t states)
+        : mass(states), surprisal(states), count(size_t(states) * kBuckets),
+          bucket_mass(size_t(states) * kBuckets), mean(size_t(states) * kBuckets),
+          low(states, kBuckets), high(states, 0) {}
+
+    void add(uint32_t state, size_t bucket, double paths, double probability) {
+        size_t cell = size_t(state) * kBuckets + bucket;
+        count[cell] += paths;
+        bucket_mass[cell] += probability;
+        low[state] = std::min(low[state], static_cast<uint32_t>(bucket));
+        high[state] = std::max(high[state], static_cast<uint32_t>(bucket + 1));
+    }
+
+    void computeMeans(uint32_t state) {
+        size_t base = size_t(state) * kBuckets;
+        for (uint32_t b = low[state]; b < high[state]; ++b) {
+            if (count[base + b] > 0.0) {
+                mean[base + b] = -std::log2(bucket_mass[base + b] / count[base + b]);
+            }
+        }
+    }
+
+    void clear(uint32_t state) {
+        size_t base = size_t(state) * kBuckets;
+        for (uint32_t b = low[state]; b < high[state]; ++b) {
+            count[base + b] = 0.0;
+            bucket_mass[base + b] = 0.0;
+        }
+        mass[state] = 0.0;
+        surprisal[state] = 0.0;
+        low[state] = kBuckets;
+        high[state] = 0;
+    }
+};
+
+void analyzeMarkov(const CompiledMarkov& chain, const Bounds& bounds, unsigned threads, Terminals& out) {
+    const uint32_t states = chain.stateCount();
+    const size_t cap = NameGenerator::kMaxMarkovLength;
+
+    // Incoming edges of each state (the chain only stores outgoing ones)
+    std::vector<uint32_t> in_offsets(states + 1, 0);
+    for (uint32_t s = 0; s < states; ++s) {
+        for (uint32_t e = chain.edgeBegin(s); e < chain.edgeEnd(s); ++e) {
+            if (chain.edgeSymbol(e) != CompiledMarkov::kBoundary && chain.edgeWeight(e) > 0) {
+                ++in_offsets[chain.advance(s, chain.edgeSymbol(e)) + 1];
+            }
+        }
+    }
+    for (uint32_t s = 0; s < states; ++s) {
+        in_offsets[s + 1] += in_offsets[s];
+    }
+    std::vector<uint32_t> in_sources(in_offsets[states]);
+    std::vector<uint32_t> in_edges(in_offsets[states]);
+    std::vector<uint32_t> cursor(in_offsets.begin(), in_offsets.end() - 1);
+    for (uint32_t s = 0; s < states; ++s) {
+        for (uint32_t e = chain.edgeBegin(s); e < chain.edgeEnd(s); ++e) {
+            if (chain.edgeSymbol(e) != CompiledMarkov::kBoundary && chain.edgeWeight(e) > 0) {
+                uint32_t slot = cursor[chain.advance(s, chain.edgeSymbol(e))]++;
+                in_sources[slot] = s;
+                in_edges[slot] = e;
+            }
+        }
+    }
+
+    Level current(states);
+    Level next(states);
+    current.mass[chain.startState()] = 1.0;
+    current.add(chain.startState(), 0, 1.0, 1.0);
+
+    for (size_t length = 0;; ++length) {
+        parallelFor(states, threads, [&](size_t begin, size_t end) {
+            for (size_t s = begin; s < end; ++s) {
+                current.computeMeans(static_cast<uint32_t>(s));
+            }
+        });
+
+        // Walks ending here: at the boundary, at a dead end, or at the cap
+        bool inside = bounds.contains(length);
+        auto finish = [&](uint32_t s, double q) {
+            double bits = -std::log2(q);
+            out.addLength(length, q * current.mass[s], q * (current.surprisal[s] + current.mass[s] * bits));
+            if (!inside) {
+                return;
+            }
+            size_t base = size_t(s) * kBuckets;
+            for (uint32_t b = current.low[s]; b < current.high[s]; ++b) {
+                if (current.count[base + b] > 0.0) {
+                    size_t bucket = bucketOf(current.mean[base + b] + bits);
+                    out.count[bucket] += current.count[base + b];
+                    out.bucket_mass[bucket] += current.bucket_mass[base + b] * q;
+                }
+            }
+        };
+        for (uint32_t s = 0; s < states; ++s) {
+            if (current.mass[s] == 0.0) {
+                continue;
+            }
+            uint64_t total = chain.stateWeight(s);
+            if (length == cap || total == 0) {
+                finish(s, 1.0);
+                continue;
+            }
+            for (uint32_t e = chain.edgeBegin(s); e < chain.edgeEnd(s); ++e) {
+                if (chain.edgeSymbol(e) == CompiledMarkov::kBoundary && chain.edgeWeight(e) > 0) {
+                    finish(s, static_cast<double>(chain.edgeWeight(e)) / static_cast<double>(total));
+                }
+            }
+        }
+        if (length == cap) {
+            break;
+        }
+
+        // One more symbol: every state pulls from its predecessors, so the
+        // sums don't depend on how states are split between threads
+        parallelFor(states, threads, [&](size_t begin, size_t end) {
+            for (uint32_t d = static_cast<uint32_t>(begin); d < end; ++d) {
+                for (uint32_t k = in_offsets[d]; k < in_offsets[d + 1]; ++k) {
+                    uint32_t s = in_sources[k];
+                    if (current.mass[s] == 0.0) {
+                        continue;
+                    }
+                    double q = static_cast<double>(chain.edgeWeight(in_edges[k])) /
+                               static_cast<double>(chain.stateWeight(s));
+                    double bits = -std::log2(q);
+                    next.mass[d] += q * current.mass[s];
+                    next.surprisal[d] += q * (current.surprisal[s] + current.mass[s] * bits);
+                    size_t base = size_t(s) * kBuckets;
+                    for (uint32_t b = current.low[s]; b < current.high[s]; ++b) {
+                        if (current.count[base + b] > 0.0) {
+                            next.add(d, bucketOf(current.mean[base + b] + bits),
+                                     current.count[base + b], current.bucket_mass[base + b] * q);
+                        }
+                    }
+                }
+            }
+        });
+
+        parallelFor(states, threads, [&](size_t begin, size_t end) {
+            for (size_t s = begin; s < end; ++s) {
+                current.clear(static_cast<uint32_t>(s));
+            }
+        });
+        std::swap(current, next);
+    }
+}
+
+void analyzeSyllables(const ProfileData& profile, const Bounds& bounds, unsigned threads, Terminals& out) {
+    const SyllableGraph& graph = profile.getSyllableGraph();
+    const double start_total = static_cast<double>(graph.startTotal());
+
+    // Depth-first over the walks from one start syllable. `probability`
+    // includes the chance that the generator allows at least depth - 1
+    // extra syllables.
+    auto walk = [&](auto& self, Terminals& terminals, int depth, uint32_t previous, uint32_t current,
+                    double probability, double surprisal, size_t length) -> void {
+        uint32_t row = graph.rowFor(previous, current);
+        uint64_t total = graph.rowWeight(row);
+        int remaining = NameGenerator::kMaxExtraSyllables - (depth - 1);
+
+        // The walk stops here if no more extra syllables were drawn, or at a
+        // dead end
+        double stop = total == 0 || remaining == 0 ? 1.0 : 1.0 / (remaining + 1);
+        double p = probability * stop;
+        double bits = surprisal - std::log2(stop);
+        terminals.addLength(length, p, p * bits);
+        if (bounds.contains(length)) {
+            size_t bucket = bucketOf(bits);
+            terminals.count[bucket] += 1.0;
+            terminals.bucket_mass[bucket] += p;
+        }
+        if (stop == 1.0) {
+            return;
+        }
+
+        double go = 1.0 - stop;
+        for (uint32_t e = graph.edgeBegin(row); e < graph.edgeEnd(row); ++e) {
+            if (graph.edgeWeight(e) == 0) {
+                continue;
+            }
+            double q = go * static_cast<double>(graph.edgeWeight(e)) / static_cast<double>(total);
+            uint32_t node = graph.edgeNode(e);
+            self(self, terminals, depth + 1, current, node, probability * q, surprisal - std::log2(q),
+                 length + graph.ref(node).length);
+        }
+    };
+
+    // Fixed chunks merged in order, so sums don't depend on the thread count
+    size_t chunks = (graph.startCount() + kStartsPerChunk - 1) / kStartsPerChunk;
+    std::vector<Terminals> results(chunks);
+    std::atomic<size_t> next_chunk{0};
+    auto worker = [&]() {
+        for (size_t chunk; (chunk = next_chunk++) < chunks;) {
+            size_t end = std::min(graph.startCount(), (chunk + 1) * kStartsPerChunk);
+            for (size_t i = chunk * kStartsPerChunk; i < end; ++i) {
+                if (graph.startWeight(i) == 0) {
+                    continue;
+                }
+                double p = static_cast<double>(graph.startWeight(i)) / start_total;
+                uint32_t node = graph.startNode(i);
+                if (graph.ref(node).length == 0) {
+                    // The generator writes "Error" for an empty start syllable
+                    Terminals& terminals = results[chunk];
+                    double bits = -std::log2(p);
+                    terminals.addLength(5, p, p * bits);
+                    if (bounds.contains(5)) {
+                        terminals.count[bucketOf(bits)] += 1.0;
+                        terminals.bucket_mass[bucketOf(bits)] += p;
+                    }
+                    continue;
+                }
+                walk(walk, results[chunk], 1, SyllableGraph::kNoNode, node, p, -std::log2(p),
+                     graph.ref(node).length);
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    unsigned count = static_cast<unsigned>(std::min<size_t>(resolveThreads(threads), std::max<size_t>(chunks, 1)));
+    for (unsigned t = 1; t < count; ++t) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    for (const Terminals& result : results) {
+        out.merge(result);
+    }
+}
+
+} // namespace
+
+ProfileAnalysis ProfileAnalyzer::analyze(const ProfileData& profile, GenerationStrategy strategy,
+                                         const AnalysisOptions& options) {
+    const Bounds bounds{options.min_length, options.max_length};
+    const unsigned threads = resolveThreads(options.threads);
+
+    // Like the generator, the syllable strategy uses markov2 without syllables
+    if (strategy == GenerationStrategy::Syllable && !profile.hasSyllables()) {
+        strategy = GenerationStrategy::Markov2;
+    }
+
+    ProfileAnalysis result;
+    result.strategy = strategy;
+    Terminals terminals;
+    const CompiledMarkov* chain = nullptr;
+    switch (strategy) {
+        case GenerationStrategy::Markov1:
+        case GenerationStrategy::Markov2:
+            chain = strategy == GenerationStrategy::Markov1 ? &profile.getMarkovOrder1() : &profile.getMarkovOrder2();
+            if (chain->empty()) {
+                throw std::runtime_error("profile has no " + std::string(NameGenerator::strategyName(strategy)) +
+                                         " chain");
+            }
+            analyzeMarkov(*chain, bounds, threads, terminals);
+            break;
+        case GenerationStrategy::Syllable:
+            if (profile.getSyllableGraph().empty()) {
+                throw std::runtime_error("profile has no start syllables");
+            }
+            analyzeSyllables(profile, bounds, threads, terminals);
+            break;
+        default:
+            throw std::runtime_error("analyze supports the markov1, markov2 and syllable strategies");
+    }
+
+    // Condition on the bounds: names inside them, renormalized
+    double all = 0.0;
+    double inside = 0.0;
+    double inside_surprisal = 0.0;
+    for (size_t length = 0; length < terminals.mass.size(); ++length) {
+        all += terminals.mass[length];
+        if (bounds.contains(length)) {
+            inside += terminals.mass[length];
+            inside_surprisal += terminals.surprisal[length];
+        }
+    }
+    if (!(inside > 0.0)) {
+        throw std::runtime_error("no name from this profile fits the length bounds");
+    }
+    result.in_bounds = inside / all;
+    result.length_probability.resize(terminals.mass.size());
+    for (size_t length = 0; length < terminals.mass.size(); ++length) {
+        result.length_probability[length] = bounds.contains(length) ? terminals.mass[length] / inside : 0.0;
+    }
+
+    // -log2(p / inside) = -log2(p) + log2(inside)
+    result.entropy = inside_surprisal / inside + std::log2(inside);
+
+    // A name of probability p is among N draws with probability 1 - (1 - p)^N;
+    // each bucket's names are taken at their mean probability
+    for (size_t b = 0; b < kBuckets; ++b) {
+        result.names += terminals.count[b];
+    }
+    for (uint64_t draws : options.draws) {
+        double expected = 0.0;
+        for (size_t b = 0; b < kBuckets; ++b) {
+            if (terminals.count[b] > 0.0) {
+                double p = std::min(1.0, terminals.bucket_mass[b] / inside / terminals.count[b]);
+                expected += terminals.count[b] * (p >= 1.0 ? 1.0 : -std::expm1(static_cast<double>(draws) * std::log1p(-p)));
+            }
+        }
+        result.expected_distinct.emplace_back(draws, expected);
+    }
+
+    if (options.top > 0) {
+        NameEnumerator enumerator(profile, strategy, options.min_length, options.max_length);
+        std::string name;
+        double probability;
+        while (result.top.size() < options.top && enumerator.next(name, probability)) {
+            result.top.emplace_back(name, probability / inside);
+        }
+    }
+    return result;
+}
@@ -1,184 +1,570 @@
 #include "ProfileData.hpp"
+#include "JsonStreamReader.hpp"
+#include "MappedFile.hpp"
+#include "Stats.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
 #include <sstream>
 
-ProfileData::ProfileData(const std::string& json_file_path) {
-    // Read file contents
-    std::ifstream file(json_file_path);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open profile file: " + json_file_path);
-    }
+namespace {
+
+// Compiled image header: magic, then format version and a byte-order mark
+constexpr char kImageMagic[8] = {'N', 'G', 'P', 'R', 'O', 'F', '\0', '\0'};
+constexpr uint32_t kByteOrderMark = 0x01020304;
 
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    std::string json_content = buffer.str();
+// Fixed-point scale for blended item weights (fits the int weights)
+constexpr double kBlendScale = 1 << 20;
 
-    // Parse JSON
-    jsom::JsonDocument doc;
-    try {
-        doc = jsom::parse_document(json_content);
-    } catch (const std::exception& e) {
-        throw std::runtime_error("Failed to parse JSON: " + std::string(e.what()));
+// Read the members of the next value if it is an object. The handler gets
+// each key and either consumes the value (returning true) or leaves it to
+// be skipped. Non-objects are skipped whole.
+template <typename Handler>
+void readMembers(JsonStreamReader& json, Handler&& handler) {
+    if (!json.beginObject()) {
+        json.skipValue();
+        return;
+    }
+    std::string key;
+    while (json.nextMember(key)) {
+        if (!handler(key)) {
+            json.skipValue();
+        }
     }
+}
 
-    // Load configuration
-    if (doc.exists("/config")) {
-        auto config = doc.at("/config");
-        if (config.exists("/markov_order")) {
-            markov_order_ = config.at("/markov_order").as<int>();
+// Read a number member that must be a whole int. NaN, fractions and
+// out-of-range values are errors rather than silently truncated.
+bool readInt(JsonStreamReader& json, const std::string& key, int& value) {
+    double number;
+    if (!json.readNumber(number)) {
+        return false;
+    }
+    if (!std::isfinite(number) || number != std::trunc(number) ||
+        number < std::numeric_limits<int>::min() || number > std::numeric_limits<int>::max()) {
+        throw std::runtime_error("Failed to parse JSON: \"" + key + "\" must be an integer");
+    }
+    value = static_cast<int>(number);
+    return true;
+}
+
+// Sort items by key, keeping only the last of equal keys (as later
+// duplicates replace earlier ones in a JSON object)
+template <typename T, typename Key>
+void sortByKey(std::vector<T>& items, Key key) {
+    auto less = [&key](const T& a, const T& b) { return key(a) < key(b); };
+    if (!std::is_sorted(items.begin(), items.end(), less)) {
+        std::stable_sort(items.begin(), items.end(), less);
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (i + 1 < items.size() && key(items[i]) == key(items[i + 1])) {
+            continue;
         }
-        if (config.exists("/syllables_enabled")) {
-            syllables_enabled_ = config.at("/syllables_enabled").as<bool>();
+        if (kept != i) {
+            items[kept] = std::move(items[i]);
         }
-        if (config.exists("/components_enabled")) {
-            components_enabled_ = config.at("/components_enabled").as<bool>();
+        ++kept;
+    }
+    items.erase(items.begin() + static_cast<std::ptrdiff_t>(kept), items.end());
+}
+
+} // namespace
+
+ProfileData::ProfileData(const std::string& profile_path) {
+    Stats::ScopedTimer timer(Stats::ProfileLoad);
+
+    // Compiled images skip JSON parsing entirely
+    if (isCompiledImage(profile_path)) {
+        loadCompiled(profile_path);
+    } else {
+        loadJson(profile_path);
+    }
+    syllable_graph_ = SyllableGraph::build(*this);
+}
+
+std::shared_ptr<const ProfileData> ProfileData::blend(const std::vector<BlendComponent>& components) {
+    if (components.empty()) {
+        throw std::invalid_argument("Blend needs at least one profile");
+    }
+    for (const auto& component : components) {
+        if (!component.profile || !(component.weight > 0) || !std::isfinite(component.weight)) {
+            throw std::invalid_argument("Blend weights must be positive numbers");
         }
     }
 
-    // Load letter-level Markov chains
-    if (doc.exists("/letter_analysis/markov_chains")) {
-        auto markov = doc.at("/letter_analysis/markov_chains");
-        if (markov.exists("/order_1")) {
-            markov_order1_ = jsonObjectToMarkov(markov.at("/order_1"));
+    Stats::ScopedTimer timer(Stats::ProfileBlend);
+    std::shared_ptr<ProfileData> blended(new ProfileData());
+    blended->markov_order_ = 1;
+    for (const auto& component : components) {
+        const ProfileData& profile = *component.profile;
+        blended->markov_order_ = std::max(blended->markov_order_, profile.markov_order_);
+        blended->syllables_enabled_ = blended->syllables_enabled_ || profile.syllables_enabled_;
+        blended->components_enabled_ = blended->components_enabled_ || profile.components_enabled_;
+    }
+
+    for (CompiledMarkov ProfileData::*chain : {&ProfileData::markov_order1_, &ProfileData::markov_order2_}) {
+        std::vector<std::pair<const CompiledMarkov*, double>> parts;
+        for (const auto& component : components) {
+            parts.emplace_back(&(component.profile.get()->*chain), component.weight);
         }
-        if (markov.exists("/order_2")) {
-            markov_order2_ = jsonObjectToMarkov(markov.at("/order_2"));
+        blended.get()->*chain = CompiledMarkov::mix(parts);
+    }
+
+    for (MarkovTable ProfileData::*table : {&ProfileData::syllable_markov1_, &ProfileData::syllable_markov2_}) {
+        std::vector<MixPart<MarkovTable>> parts;
+        for (const auto& component : components) {
+            const ProfileData& profile = *component.profile;
+            parts.push_back({&profile.strings_, &(profile.*table), component.weight});
         }
+        blended.get()->*table = blended->mixTables(parts);
     }
 
-    // Load positional n-grams
-    if (doc.exists("/letter_analysis/positional_bigrams")) {
-        auto pos_bigrams = doc.at("/letter_analysis/positional_bigrams");
-        if (pos_bigrams.exists("/start")) {
-            bigrams_start_ = jsonObjectToWeighted(pos_bigrams.at("/start"));
+    for (WeightedList ProfileData::*list : {&ProfileData::syllables_start_, &ProfileData::syllables_middle_,
+                                            &ProfileData::syllables_end_, &ProfileData::onsets_start_,
+                                            &ProfileData::onsets_middle_, &ProfileData::onsets_end_,
+                                            &ProfileData::nuclei_, &ProfileData::codas_,
+                                            &ProfileData::codas_start_, &ProfileData::codas_middle_,
+                                            &ProfileData::codas_end_, &ProfileData::bigrams_start_,
+                                            &ProfileData::bigrams_middle_, &ProfileData::bigrams_end_,
+                                            &ProfileData::trigrams_start_, &ProfileData::trigrams_middle_,
+                                            &ProfileData::trigrams_end_}) {
+        std::vector<MixPart<WeightedList>> parts;
+        for (const auto& component : components) {
+            const ProfileData& profile = *component.profile;
+            parts.push_back({&profile.strings_, &(profile.*list), component.weight});
         }
-        if (pos_bigrams.exists("/middle")) {
-            bigrams_middle_ = jsonObjectToWeighted(pos_bigrams.at("/middle"));
+        blended.get()->*list = blended->mixLists(parts);
+    }
+    blended->strings_.shrinkToFit();
+    blended->syllable_graph_ = SyllableGraph::build(*blended);
+    return blended;
+}
+
+std::vector<std::pair<std::string, double>> ProfileData::parseBlendSpec(std::string_view spec) {
+    std::vector<std::pair<std::string, double>> parts;
+    size_t begin = 0;
+    while (begin <= spec.size()) {
+        size_t end = std::min(spec.find(',', begin), spec.size());
+        std::string_view part = spec.substr(begin, end - begin);
+        begin = end + 1;
+
+        double weight = 1;
+        size_t colon = part.rfind(':');
+        if (colon != std::string_view::npos) {
+            std::string_view number = part.substr(colon + 1);
+            auto [stop, error] = std::from_chars(number.data(), number.data() + number.size(), weight);
+            if (error != std::errc() || stop != number.data() + number.size() || !(weight > 0) ||
+                !std::isfinite(weight)) {
+                throw std::invalid_argument("Invalid blend weight '" + std::string(number) + "'");
+            }
+            part = part.substr(0, colon);
         }
-        if (pos_bigrams.exists("/end")) {
-            bigrams_end_ = jsonObjectToWeighted(pos_bigrams.at("/end"));
+        if (part.empty()) {
+            throw std::invalid_argument("Blend spec has an empty profile: '" + std::string(spec) + "'");
         }
+        parts.emplace_back(std::string(part), weight);
     }
+    return parts;
+}
 
-    if (doc.exists("/letter_analysis/positional_trigrams")) {
-        auto pos_trigrams = doc.at("/letter_analysis/positional_trigrams");
-        if (pos_trigrams.exists("/start")) {
-            trigrams_start_ = jsonObjectToWeighted(pos_trigrams.at("/start"));
+ProfileData::WeightedList ProfileData::mixLists(const std::vector<MixPart<WeightedList>>& lists) {
+    // Keyed by text (the inputs' pools differ), which also fixes the item order
+    std::map<std::string_view, double> mass;
+    double weight_sum = 0;
+    for (const auto& [strings, list, weight] : lists) {
+        uint64_t total = 0;
+        for (const auto& item : list->items()) {
+            total += item.weight > 0 ? static_cast<uint64_t>(item.weight) : 0;
         }
-        if (pos_trigrams.exists("/middle")) {
-            trigrams_middle_ = jsonObjectToWeighted(pos_trigrams.at("/middle"));
+        if (total == 0) {
+            continue;
         }
-        if (pos_trigrams.exists("/end")) {
-            trigrams_end_ = jsonObjectToWeighted(pos_trigrams.at("/end"));
+        weight_sum += weight;
+        for (const auto& item : list->items()) {
+            if (item.weight > 0) {
+                mass[strings->view(item.value)] += weight * item.weight / static_cast<double>(total);
+            }
         }
     }
 
-    // Load syllable data
-    if (syllables_enabled_ && doc.exists("/syllable_analysis")) {
-        auto syllable = doc.at("/syllable_analysis");
+    std::vector<WeightedItem> items;
+    items.reserve(mass.size());
+    for (auto& [value, item_mass] : mass) {
+        double scaled = std::round(item_mass / weight_sum * kBlendScale);
+        items.push_back({strings_.intern(value), std::max(1, static_cast<int>(scaled))});
+    }
+    return WeightedList(std::move(items));
+}
 
-        if (syllable.exists("/positional_syllables")) {
-            auto pos_syl = syllable.at("/positional_syllables");
-            if (pos_syl.exists("/start")) {
-                syllables_start_ = jsonObjectToWeighted(pos_syl.at("/start"));
-            }
-            if (pos_syl.exists("/middle")) {
-                syllables_middle_ = jsonObjectToWeighted(pos_syl.at("/middle"));
-            }
-            if (pos_syl.exists("/end")) {
-                syllables_end_ = jsonObjectToWeighted(pos_syl.at("/end"));
-            }
+ProfileData::MarkovTable ProfileData::mixTables(const std::vector<MixPart<MarkovTable>>& tables) {
+    std::map<std::string_view, std::vector<MixPart<WeightedList>>> contexts;
+    for (const auto& [strings, table, weight] : tables) {
+        for (const auto& [context, list] : *table) {
+            contexts[strings->view(context)].push_back({strings, &list, weight});
         }
+    }
 
-        if (syllable.exists("/syllable_markov")) {
-            auto syl_markov = syllable.at("/syllable_markov");
-            if (syl_markov.exists("/order_1")) {
-                syllable_markov1_ = jsonObjectToMarkov(syl_markov.at("/order_1"));
-            }
-            if (syl_markov.exists("/order_2")) {
-                syllable_markov2_ = jsonObjectToMarkov(syl_markov.at("/order_2"));
-            }
+    MarkovTable result;
+    for (const auto& [context, lists] : contexts) {
+        WeightedList mixed = mixLists(lists);
+        if (!mixed.empty()) {
+            result.emplace(strings_.intern(context), std::move(mixed));
         }
     }
+    return result;
+}
 
-    // Load component data
-    if (components_enabled_ && doc.exists("/component_analysis")) {
-        auto comp = doc.at("/component_analysis");
+bool ProfileData::isCompiledImage(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char header[sizeof(kImageMagic)] = {};
+    if (!file.read(header, sizeof(header))) {
+        return false;
+    }
+    return std::memcmp(header, kImageMagic, sizeof(kImageMagic)) == 0;
+}
 
-        // Load nuclei (all positions use same nuclei)
-        if (comp.exists("/frequencies/nuclei")) {
-            nuclei_ = jsonObjectToWeighted(comp.at("/frequencies/nuclei"));
-        }
+void ProfileData::saveCompiled(const std::string& image_path) const {
+    BinaryWriter out;
+    for (char c : kImageMagic) {
+        out.put(c);
+    }
+    out.put(kImageVersion);
+    out.put(kByteOrderMark);
+    out.put(static_cast<int32_t>(markov_order_));
+    out.put(static_cast<uint8_t>(syllables_enabled_));
+    out.put(static_cast<uint8_t>(components_enabled_));
+
+    // Letter-level chains, laid out for in-place use
+    markov_order1_.write(out);
+    markov_order2_.write(out);
+
+    // String-valued tables, always in this order, after the strings they use
+    strings_.write(out);
+    for (const WeightedList* list : {&syllables_start_, &syllables_middle_, &syllables_end_}) {
+        writeList(out, *list);
+    }
+    writeTable(out, syllable_markov1_);
+    writeTable(out, syllable_markov2_);
+    for (const WeightedList* list : {&onsets_start_, &onsets_middle_, &onsets_end_, &nuclei_, &codas_,
+                                     &codas_start_, &codas_middle_, &codas_end_,
+                                     &bigrams_start_, &bigrams_middle_, &bigrams_end_,
+                                     &trigrams_start_, &trigrams_middle_, &trigrams_end_}) {
+        writeList(out, *list);
+    }
+
+    MappedFile::writeAtomically(image_path, out.data(), "profile image");
+}
 
-        // Load codas (general)
-        if (comp.exists("/frequencies/codas")) {
-            codas_ = jsonObjectToWeighted(comp.at("/frequencies/codas"));
+void ProfileData::loadCompiled(const std::string& image_path) {
+    auto image = std::make_shared<MappedFile>(image_path);
+    BinaryReader in(image->data(), image->size());
+
+    for (char c : kImageMagic) {
+        if (in.get<char>() != c) {
+            throw std::runtime_error("Not a compiled profile image: " + image_path);
         }
+    }
+    uint32_t version = in.get<uint32_t>();
+    if (version != kImageVersion) {
+        throw std::runtime_error("Unsupported profile image version " + std::to_string(version) +
+                                 " (expected " + std::to_string(kImageVersion) + "), recompile " + image_path);
+    }
+    if (in.get<uint32_t>() != kByteOrderMark) {
+        throw std::runtime_error("Profile image was compiled on a machine with different byte order: " + image_path);
+    }
 
-        // Load positional onsets
-        if (comp.exists("/positional_onsets")) {
-            auto pos_onsets = comp.at("/positional_onsets");
-            if (pos_onsets.exists("/start")) {
-                onsets_start_ = jsonObjectToWeighted(pos_onsets.at("/start"));
-            }
-            if (pos_onsets.exists("/middle")) {
-                onsets_middle_ = jsonObjectToWeighted(pos_onsets.at("/middle"));
-            }
-            if (pos_onsets.exists("/end")) {
-                onsets_end_ = jsonObjectToWeighted(pos_onsets.at("/end"));
-            }
+    markov_order_ = in.get<int32_t>();
+    syllables_enabled_ = in.get<uint8_t>() != 0;
+    components_enabled_ = in.get<uint8_t>() != 0;
+
+    // The chains point into the mapping and keep it alive
+    markov_order1_ = CompiledMarkov::view(in, image);
+    markov_order2_ = CompiledMarkov::view(in, image);
+
+    strings_ = StringPool::read(in);
+    for (WeightedList* list : {&syllables_start_, &syllables_middle_, &syllables_end_}) {
+        *list = readList(in);
+    }
+    syllable_markov1_ = readTable(in);
+    syllable_markov2_ = readTable(in);
+    for (WeightedList* list : {&onsets_start_, &onsets_middle_, &onsets_end_, &nuclei_, &codas_,
+                               &codas_start_, &codas_middle_, &codas_end_,
+                               &bigrams_start_, &bigrams_middle_, &bigrams_end_,
+                               &trigrams_start_, &trigrams_middle_, &trigrams_end_}) {
+        *list = readList(in);
+    }
+}
+
+void ProfileData::writeList(BinaryWriter& out, const WeightedList& list) {
+    out.put(static_cast<uint32_t>(list.size()));
+    out.putArray(std::span<const WeightedItem>(list.items()));
+}
+
+ProfileData::WeightedList ProfileData::readList(BinaryReader& in) const {
+    uint32_t count = in.get<uint32_t>();
+    std::span<const WeightedItem> stored = in.array<WeightedItem>(count);
+    for (const auto& item : stored) {
+        if (!strings_.contains(item.value)) {
+            throw std::runtime_error("Corrupt profile image: string out of bounds");
         }
+    }
+    return WeightedList(std::vector<WeightedItem>(stored.begin(), stored.end()));
+}
 
-        // Load positional codas
-        if (comp.exists("/positional_codas")) {
-            auto pos_codas = comp.at("/positional_codas");
-            if (pos_codas.exists("/start")) {
-                codas_start_ = jsonObjectToWeighted(pos_codas.at("/start"));
-            }
-            if (pos_codas.exists("/middle")) {
-                codas_middle_ = jsonObjectToWeighted(pos_codas.at("/middle"));
-            }
-            if (pos_codas.exists("/end")) {
-                codas_end_ = jsonObjectToWeighted(pos_codas.at("/end"));
-            }
+void ProfileData::writeTable(BinaryWriter& out, const MarkovTable& table) {
+    out.put(static_cast<uint32_t>(table.size()));
+    for (const auto& [context, list] : table) {
+        out.put(context);
+        writeList(out, list);
+    }
+}
+
+ProfileData::MarkovTable ProfileData::readTable(BinaryReader& in) const {
+    uint32_t count = in.get<uint32_t>();
+    MarkovTable table;
+    for (uint32_t i = 0; i < count; ++i) {
+        auto context = in.get<StringPool::Ref>();
+        if (!strings_.contains(context)) {
+            throw std::runtime_error("Corrupt profile image: string out of bounds");
         }
+        table.emplace(context, readList(in));
     }
+    return table;
 }
 
-std::vector<ProfileData::WeightedItem> ProfileData::jsonObjectToWeighted(const jsom::JsonDocument& obj) {
-    std::vector<WeightedItem> result;
+ProfileData::WeightedList::WeightedList(std::vector<WeightedItem> items)
+    : items_(std::move(items)) {
+    // Negative counts can't be sampled; treat them as zero
+    std::vector<uint64_t> weights;
+    weights.reserve(items_.size());
+    for (const auto& item : items_) {
+        weights.push_back(item.weight > 0 ? static_cast<uint64_t>(item.weight) : 0);
+    }
+    sampler_ = AliasTable(weights);
+}
 
-    if (!obj.is_object()) {
-        return result;
+size_t ProfileData::WeightedList::memoryUsage() const {
+    // Values are counted once, in the profile's string pool
+    return items_.capacity() * sizeof(WeightedItem) + sampler_.size() * (sizeof(uint64_t) + sizeof(uint32_t));
+}
+
+size_t ProfileData::memoryUsage() const {
+    // Rough per-node cost of a std::map: the value plus three pointers and a color
+    constexpr size_t kMapNodeOverhead = 4 * sizeof(void*);
+
+    size_t bytes = sizeof(ProfileData) + strings_.memoryUsage() + syllable_graph_.memoryUsage() +
+                   markov_order1_.memoryUsage() + markov_order2_.memoryUsage();
+    for (const MarkovTable* table : {&syllable_markov1_, &syllable_markov2_}) {
+        for (const auto& entry : *table) {
+            bytes += sizeof(MarkovTable::value_type) + kMapNodeOverhead + entry.second.memoryUsage();
+        }
+    }
+    for (const WeightedList* list : {&syllables_start_, &syllables_middle_, &syllables_end_,
+                                     &onsets_start_, &onsets_middle_, &onsets_end_, &nuclei_, &codas_,
+                                     &codas_start_, &codas_middle_, &codas_end_,
+                                     &bigrams_start_, &bigrams_middle_, &bigrams_end_,
+                                     &trigrams_start_, &trigrams_middle_, &trigrams_end_}) {
+        bytes += list->memoryUsage();
     }
+    return bytes;
+}
 
-    // JSOM doesn't expose object iteration directly, so we'll use the paths
-    // For each key in the object, get the value
-    // We need to access the object members through the variant
-    const auto& obj_map = obj.as<std::map<std::string, jsom::JsonDocument>>();
+void ProfileData::loadJson(const std::string& path) {
+    // Tables are filled as their members are read; nothing else of the file
+    // is kept. The config flags gate the syllable and component sections:
+    // sections seen after config are skipped when disabled, and sections
+    // seen before it are dropped at the end.
+    JsonStreamReader json(path);
+    if (!json.beginObject()) {
+        throw std::runtime_error("Failed to parse JSON: a profile must be an object");
+    }
 
-    for (const auto& [key, value] : obj_map) {
-        if (value.is_number()) {
-            result.push_back({key, value.as<int>()});
+    bool config_seen = false;
+    std::string key;
+    while (json.nextMember(key)) {
+        if (key == "config") {
+            readMembers(json, [&](const std::string& name) {
+                if (name == "markov_order") {
+                    return readInt(json, name, markov_order_);
+                }
+                if (name == "syllables_enabled") {
+                    return json.readBool(syllables_enabled_);
+                }
+                if (name == "components_enabled") {
+                    return json.readBool(components_enabled_);
+                }
+                return false;
+            });
+            config_seen = true;
+        } else if (key == "letter_analysis") {
+            readMembers(json, [&](const std::string& section) {
+                if (section == "markov_chains") {
+                    readMembers(json, [&](const std::string& order) {
+                        if (order == "order_1") {
+                            markov_order1_ = readMarkovChain(json, 1);
+                        } else if (order == "order_2") {
+                            markov_order2_ = readMarkovChain(json, 2);
+                        } else {
+                            return false;
+                        }
+                        return true;
+                    });
+                } else if (section == "positional_bigrams") {
+                    readPositional(json, bigrams_start_, bigrams_middle_, bigrams_end_);
+                } else if (section == "positional_trigrams") {
+                    readPositional(json, trigrams_start_, trigrams_middle_, trigrams_end_);
+                } else {
+                    return false;
+                }
+                return true;
+            });
+        } else if (key == "syllable_analysis" && (!config_seen || syllables_enabled_)) {
+            readMembers(json, [&](const std::string& section) {
+                if (section == "positional_syllables") {
+                    readPositional(json, syllables_start_, syllables_middle_, syllables_end_);
+                } else if (section == "syllable_markov") {
+                    readMembers(json, [&](const std::string& order) {
+                        if (order == "order_1") {
+                            syllable_markov1_ = readMarkovTable(json);
+                        } else if (order == "order_2") {
+                            syllable_markov2_ = readMarkovTable(json);
+                        } else {
+                            return false;
+                        }
+                        return true;
+                    });
+                } else {
+                    return false;
+                }
+                return true;
+            });
+        } else if (key == "component_analysis" && (!config_seen || components_enabled_)) {
+            readMembers(json, [&](const std::string& section) {
+                if (section == "frequencies") {
+                    // All positions use the same nuclei
+                    readMembers(json, [&](const std::string& name) {
+                        if (name == "nuclei") {
+                            nuclei_ = readWeighted(json);
+                        } else if (name == "codas") {
+                            codas_ = readWeighted(json);
+                        } else {
+                            return false;
+                        }
+                        return true;
+                    });
+                } else if (section == "positional_onsets") {
+                    readPositional(json, onsets_start_, onsets_middle_, onsets_end_);
+                } else if (section == "positional_codas") {
+                    readPositional(json, codas_start_, codas_middle_, codas_end_);
+                } else {
+                    return false;
+                }
+                return true;
+            });
+        } else {
+            json.skipValue();
         }
     }
+    json.expectEnd();
+    strings_.shrinkToFit();
 
-    return result;
+    if (!syllables_enabled_) {
+        syllables_start_ = syllables_middle_ = syllables_end_ = WeightedList();
+        syllable_markov1_.clear();
+        syllable_markov2_.clear();
+    }
+    if (!components_enabled_) {
+        for (WeightedList* list : {&onsets_start_, &onsets_middle_, &onsets_end_, &nuclei_, &codas_,
+                                   &codas_start_, &codas_middle_, &codas_end_}) {
+            *list = WeightedList();
+        }
+    }
+}
+
+ProfileData::WeightedList ProfileData::readWeighted(JsonStreamReader& json) {
+    std::vector<WeightedItem> items;
+    readMembers(json, [&](const std::string& key) {
+        int weight;
+        if (!readInt(json, key, weight)) {
+            return false;
+        }
+        items.push_back({strings_.intern(key), weight});
+        return true;
+    });
+    sortByKey(items, [this](const WeightedItem& item) { return strings_.view(item.value); });
+    return WeightedList(std::move(items));
+}
+
+void ProfileData::readPositional(JsonStreamReader& json, WeightedList& start, WeightedList& middle,
+                                 WeightedList& end) {
+    readMembers(json, [&](const std::string& position) {
+        WeightedList* list = position == "start" ? &start : position == "middle" ? &middle :
+                             position == "end" ? &end : nullptr;
+        if (list) {
+            *list = readWeighted(json);
+        }
+        return list != nullptr;
+    });
 }
 
-std::map<std::string, std::vector<ProfileData::WeightedItem>> ProfileData::jsonObjectToMarkov(const jsom::JsonDocument& obj) {
-    std::map<std::string, std::vector<WeightedItem>> result;
+ProfileData::MarkovTable ProfileData::readMarkovTable(JsonStreamReader& json) {
+    MarkovTable table;
+    readMembers(json, [&](const std::string& context) {
+        if (json.peek() != '{') {
+            return false;
+        }
+        StringPool::Ref ref = strings_.intern(context);
+        table[ref] = readWeighted(json);
+        return true;
+    });
+    return table;
+}
 
-    if (!obj.is_object()) {
-        return result;
+CompiledMarkov ProfileData::readMarkovChain(JsonStreamReader& json, int order) {
+    // Transitions are packed as context + next byte; compile() ignores any
+    // other shape, so those are dropped as they are read
+    struct Packed {
+        char symbols[3];
+        int weight;
+    };
+    if (order < 1 || order > 2) {
+        throw std::invalid_argument("readMarkovChain: order must be 1 or 2");
     }
+    size_t length = static_cast<size_t>(order);
 
-    const auto& obj_map = obj.as<std::map<std::string, jsom::JsonDocument>>();
+    std::vector<Packed> packed;
+    readMembers(json, [&](const std::string& context) {
+        if (json.peek() != '{') {
+            return false;
+        }
+        readMembers(json, [&](const std::string& next) {
+            int weight;
+            if (!readInt(json, next, weight)) {
+                return false;
+            }
+            if (context.size() == length && next.size() == 1) {
+                Packed transition{};
+                std::memcpy(transition.symbols, context.data(), length);
+                transition.symbols[length] = next[0];
+                transition.weight = weight;
+                packed.push_back(transition);
+            }
+            return true;
+        });
+        return true;
+    });
+    sortByKey(packed, [length](const Packed& p) { return std::string_view(p.symbols, length + 1); });
 
-    for (const auto& [context, transitions] : obj_map) {
-        if (transitions.is_object()) {
-            result[context] = jsonObjectToWeighted(transitions);
+    std::vector<CompiledMarkov::Transition> transitions;
+    transitions.reserve(packed.size());
+    for (const Packed& p : packed) {
+        if (p.weight > 0) {
+            transitions.push_back({std::string_view(p.symbols, length), std::string_view(p.symbols + length, 1),
+                                   static_cast<uint64_t>(p.weight)});
         }
     }
-
-    return result;
+    return CompiledMarkov::compile(order, transitions);
 }
@@ -0,0 +1,235 @@
+#include "ProfileRegistry.hpp"
+#include <filesystem>
+#include <iterator>
+#include <stdexcept>
+
+ProfileRegistry::ProfileRegistry(size_t memory_budget) : memory_budget_(memory_budget) {
+}
+
+void ProfileRegistry::add(const std::string& name, const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry& entry = entries_[name];
+    if (entry.path != path) {
+        unload(entry);
+        entry.path = path;
+    }
+}
+
+size_t ProfileRegistry::addDirectory(const std::string& directory) {
+    std::map<std::string, std::filesystem::path> found;
+    std::error_code error;
+    for (const auto& file : std::filesystem::directory_iterator(directory, error)) {
+        const std::filesystem::path& path = file.path();
+        std::string extension = path.extension().string();
+        if (!file.is_regular_file() || (extension != ".json" && extension != ".ngp")) {
+            continue;
+        }
+        auto [it, inserted] = found.emplace(path.stem().string(), path);
+        if (!inserted && extension == ".ngp") {
+            it->second = path;
+        }
+    }
+    if (error) {
+        throw std::runtime_error("Failed to read profile directory " + directory + " (" + error.message() + ")");
+    }
+
+    for (const auto& [name, path] : found) {
+        add(name, path.string());
+    }
+    return found.size();
+}
+
+std::shared_ptr<const ProfileData> ProfileRegistry::get(std::string_view name) {
+    std::promise<Profile> loading;
+    std::shared_future<Profile> pending;
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(name);
+        if (it == entries_.end()) {
+            throw std::runtime_error("Unknown profile: " + std::string(name));
+        }
+        Entry& entry = it->second;
+        if (entry.resident) {
+            recent_.splice(recent_.begin(), recent_, entry.recent);
+            return entry.profile.get();
+        }
+        if (entry.profile.valid()) {
+            pending = entry.profile;  // Another thread is loading it
+        } else {
+            entry.profile = loading.get_future().share();
+            path = entry.path;
+        }
+    }
+    if (pending.valid()) {
+        return pending.get();
+    }
+
+    // Load without holding the lock, so other profiles stay available
+    std::filesystem::file_time_type modified = modificationTime(path);
+    Profile profile;
+    try {
+        profile = std::make_shared<const ProfileData>(path);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(name);
+        if (it != entries_.end() && !it->second.resident && it->second.path == path) {
+            it->second.profile = {};
+        }
+        loading.set_exception(std::current_exception());
+        throw;
+    }
+
+    size_t bytes = profile->memoryUsage();
+    std::lock_guard<std::mutex> lock(mutex_);
+    loading.set_value(profile);
+
+    // Only account for it if the entry wasn't re-registered meanwhile
+    auto it = entries_.find(name);
+    if (it != entries_.end() && !it->second.resident && it->second.path == path) {
+        Entry& entry = it->second;
+        entry.resident = true;
+        entry.bytes = bytes;
+        entry.modified = modified;
+        entry.recent = recent_.insert(recent_.begin(), it->first);
+        resident_bytes_ += bytes;
+        evict(&entry);
+    }
+    return profile;
+}
+
+bool ProfileRegistry::reload(std::string_view name) {
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(name);
+        if (it == entries_.end() || !it->second.resident || it->second.reloading) {
+            return false;
+        }
+        it->second.reloading = true;
+        path = it->second.path;
+    }
+
+    // Build the new version while get() keeps handing out the old one
+    std::filesystem::file_time_type modified = modificationTime(path);
+    Profile profile;
+    try {
+        profile = std::make_shared<const ProfileData>(path);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.find(name)->second.reloading = false;
+        throw;
+    }
+    size_t bytes = profile->memoryUsage();
+    std::promise<Profile> ready;
+    ready.set_value(std::move(profile));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry& entry = entries_.find(name)->second;
+    entry.reloading = false;
+    if (!entry.resident || entry.path != path) {
+        return false;  // Evicted or re-registered meanwhile
+    }
+    entry.profile = ready.get_future().share();
+    resident_bytes_ = resident_bytes_ - entry.bytes + bytes;
+    entry.bytes = bytes;
+    entry.modified = modified;
+    evict(&entry);
+    return true;
+}
+
+std::vector<std::string> ProfileRegistry::reloadChanged(std::vector<std::string>* errors) {
+    std::vector<std::pair<std::string, std::string>> candidates;  // (name, path)
+    std::vector<std::filesystem::file_time_type> loaded_times;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [name, entry] : entries_) {
+            if (entry.resident) {
+                candidates.emplace_back(name, entry.path);
+                loaded_times.push_back(entry.modified);
+            }
+        }
+    }
+
+    std::vector<std::string> reloaded;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        const auto& [name, path] = candidates[i];
+        if (modificationTime(path) == loaded_times[i]) {
+            continue;
+        }
+        try {
+            if (reload(name)) {
+                reloaded.push_back(name);
+            }
+        } catch (const std::exception& e) {
+            if (errors) {
+                errors->push_back(name + ": " + e.what());
+            }
+        }
+    }
+    return reloaded;
+}
+
+bool ProfileRegistry::contains(std::string_view name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.find(name) != entries_.end();
+}
+
+std::vector<std::string> ProfileRegistry::names() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> result;
+    result.reserve(entries_.size());
+    for (const auto& entry : entries_) {
+        result.push_back(entry.first);
+    }
+    return result;
+}
+
+void ProfileRegistry::setMemoryBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    memory_budget_ = bytes;
+    evict(nullptr);
+}
+
+size_t ProfileRegistry::residentCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return recent_.size();
+}
+
+size_t ProfileRegistry::residentBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return resident_bytes_;
+}
+
+void ProfileRegistry::evict(const Entry* keep) {
+    if (memory_budget_ == 0) {
+        return;
+    }
+    auto candidate = recent_.end();
+    while (resident_bytes_ > memory_budget_ && candidate != recent_.begin()) {
+        --candidate;
+        Entry& entry = entries_.find(*candidate)->second;
+        if (&entry == keep) {
+            continue;  // Just loaded for a caller; may exceed the budget alone
+        }
+        auto next = std::next(candidate);
+        unload(entry);
+        candidate = next;
+    }
+}
+
+std::filesystem::file_time_type ProfileRegistry::modificationTime(const std::string& path) {
+    std::error_code error;
+    std::filesystem::file_time_type time = std::filesystem::last_write_time(path, error);
+    return error ? std::filesystem::file_time_type::min() : time;
+}
+
+void ProfileRegistry::unload(Entry& entry) {
+    if (entry.resident) {
+        recent_.erase(entry.recent);
+        resident_bytes_ -= entry.bytes;
+        entry.resident = false;
+        entry.bytes = 0;
+    }
+    entry.profile = {};
+}
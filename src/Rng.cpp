@@ -0,0 +1,141 @@
+#include "Rng.hpp"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+// SplitMix64 step: expands one seed into well-mixed state words
+uint64_t splitMix64(uint64_t& state) {
+    uint64_t value = (state += 0x9E3779B97F4A7C15ULL);
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+} // namespace
+
+Rng::Rng(RngKind kind, uint64_t seed) : kind_(kind) {
+    seedStream(seed, 0);
+}
+
+Rng::Rng(const Rng& other) {
+    *this = other;
+}
+
+Rng& Rng::operator=(const Rng& other) {
+    if (this == &other) {
+        return *this;
+    }
+    kind_ = other.kind_;
+    std::copy(std::begin(other.xoshiro_), std::end(other.xoshiro_), xoshiro_);
+    pcg_high_ = other.pcg_high_;
+    pcg_low_ = other.pcg_low_;
+    pcg_inc_high_ = other.pcg_inc_high_;
+    pcg_inc_low_ = other.pcg_inc_low_;
+    philox_key_ = other.philox_key_;
+    philox_block_ = other.philox_block_;
+    philox_stream_ = other.philox_stream_;
+    std::copy(std::begin(other.philox_out_), std::end(other.philox_out_), philox_out_);
+    philox_index_ = other.philox_index_;
+    mt_ = other.mt_ ? std::make_unique<std::mt19937_64>(*other.mt_) : nullptr;
+    return *this;
+}
+
+void Rng::seedStream(uint64_t seed, uint64_t stream) {
+    if (kind_ == RngKind::Philox) {
+        // Counter-based: the stream id selects a disjoint counter range
+        philox_key_ = seed;
+        philox_stream_ = stream;
+        philox_block_ = 0;
+        philox_index_ = 2;
+        return;
+    }
+
+    // Hash the seed, then key a second round on it with the stream, so
+    // neighbouring streams are unrelated and (seed, stream) isn't symmetric
+    uint64_t mix = seed;
+    uint64_t state = splitMix64(mix);
+    state ^= stream * 0x9E3779B97F4A7C15ULL;
+    state = splitMix64(state);
+
+    switch (kind_) {
+        case RngKind::Xoshiro256pp:
+            for (uint64_t& word : xoshiro_) {
+                word = splitMix64(state);
+            }
+            break;
+        case RngKind::Pcg64:
+            pcg_inc_high_ = splitMix64(state);
+            pcg_inc_low_ = splitMix64(state) | 1;  // Increment must be odd
+            pcg_high_ = 0;
+            pcg_low_ = 0;
+            nextPcg();
+            pcg_high_ += splitMix64(state);
+            pcg_low_ += splitMix64(state);
+            nextPcg();
+            break;
+        case RngKind::Mt19937:
+            // Seeded straight from the mixed word; a seed_seq would allocate
+            // on every per-name reseed
+            if (mt_) {
+                mt_->seed(state);
+            } else {
+                mt_ = std::make_unique<std::mt19937_64>(state);
+            }
+            break;
+        case RngKind::Philox:
+            break;
+    }
+}
+
+void Rng::philoxBlock() {
+    // Philox4x32-10 over the 128-bit counter (block, stream)
+    constexpr uint32_t kMul0 = 0xD2511F53;
+    constexpr uint32_t kMul1 = 0xCD9E8D57;
+    constexpr uint32_t kWeyl0 = 0x9E3779B9;
+    constexpr uint32_t kWeyl1 = 0xBB67AE85;
+
+    uint32_t c0 = static_cast<uint32_t>(philox_block_);
+    uint32_t c1 = static_cast<uint32_t>(philox_block_ >> 32);
+    uint32_t c2 = static_cast<uint32_t>(philox_stream_);
+    uint32_t c3 = static_cast<uint32_t>(philox_stream_ >> 32);
+    uint32_t k0 = static_cast<uint32_t>(philox_key_);
+    uint32_t k1 = static_cast<uint32_t>(philox_key_ >> 32);
+
+    for (int round = 0; round < 10; ++round) {
+        uint64_t product0 = static_cast<uint64_t>(kMul0) * c0;
+        uint64_t product1 = static_cast<uint64_t>(kMul1) * c2;
+        uint32_t next0 = static_cast<uint32_t>(product1 >> 32) ^ c1 ^ k0;
+        uint32_t next2 = static_cast<uint32_t>(product0 >> 32) ^ c3 ^ k1;
+        c1 = static_cast<uint32_t>(product1);
+        c3 = static_cast<uint32_t>(product0);
+        c0 = next0;
+        c2 = next2;
+        k0 += kWeyl0;
+        k1 += kWeyl1;
+    }
+
+    philox_out_[0] = (static_cast<uint64_t>(c1) << 32) | c0;
+    philox_out_[1] = (static_cast<uint64_t>(c3) << 32) | c2;
+    ++philox_block_;
+}
+
+const char* Rng::kindName(RngKind kind) {
+    switch (kind) {
+        case RngKind::Xoshiro256pp: return "xoshiro256pp";
+        case RngKind::Pcg64: return "pcg64";
+        case RngKind::Philox: return "philox";
+        case RngKind::Mt19937: return "mt19937";
+    }
+    return "unknown";
+}
+
+bool Rng::parseKind(std::string_view name, RngKind& kind) {
+    for (RngKind candidate : {RngKind::Xoshiro256pp, RngKind::Pcg64, RngKind::Philox, RngKind::Mt19937}) {
+        if (name == kindName(candidate)) {
+            kind = candidate;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,143 @@
+#include "ShardManifest.hpp"
+#include "MappedFile.hpp"
+#include "UniqueNameSet.hpp"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <jsom/jsom.hpp>
+
+namespace {
+
+constexpr const char* kFormat = "namegen-shard-manifest";
+constexpr int kVersion = 1;
+
+std::string quoted(const std::string& text) {
+    std::string result = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned>(c));
+            result += buffer;
+        } else {
+            result += c;
+        }
+    }
+    return result + '"';
+}
+
+// 64-bit values are stored as strings so they survive readers that hold
+// JSON numbers as doubles
+uint64_t readCount(const jsom::JsonDocument& doc, const char* path) {
+    return std::stoull(doc.at(path).as<std::string>());
+}
+
+std::string readString(const jsom::JsonDocument& doc, const char* path) {
+    return doc.exists(path) ? doc.at(path).as<std::string>() : std::string();
+}
+
+} // namespace
+
+void ShardManifest::save(const std::string& path) const {
+    std::ostringstream json;
+    json << "{\n"
+         << "  \"format\": " << quoted(kFormat) << ",\n"
+         << "  \"version\": " << kVersion << ",\n"
+         << "  \"seed\": \"" << seed << "\",\n"
+         << "  \"rng\": " << quoted(rng) << ",\n"
+         << "  \"profile\": " << quoted(profile) << ",\n"
+         << "  \"profile_hash\": " << quoted(profile_hash) << ",\n"
+         << "  \"profile2\": " << quoted(profile2) << ",\n"
+         << "  \"profile2_hash\": " << quoted(profile2_hash) << ",\n"
+         << "  \"exclude\": " << quoted(exclude) << ",\n"
+         << "  \"exclude_hash\": " << quoted(exclude_hash) << ",\n"
+         << "  \"strategy\": " << quoted(strategy) << ",\n"
+         << "  \"min_length\": " << min_length << ",\n"
+         << "  \"max_length\": " << max_length << ",\n"
+         << "  \"total_count\": \"" << total_count << "\",\n"
+         << "  \"shard\": " << shard << ",\n"
+         << "  \"shards\": " << shards << ",\n"
+         << "  \"first_index\": \"" << first_index << "\",\n"
+         << "  \"count\": \"" << count << "\",\n"
+         << "  \"output\": " << quoted(output) << "\n"
+         << "}\n";
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to create manifest: " + path);
+    }
+    file << json.str();
+    if (!file.flush()) {
+        throw std::runtime_error("Failed to write manifest: " + path);
+    }
+}
+
+ShardManifest ShardManifest::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open manifest: " + path);
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+
+    ShardManifest manifest;
+    try {
+        jsom::JsonDocument doc = jsom::parse_document(buffer.str());
+        if (!doc.exists("/format") || doc.at("/format").as<std::string>() != kFormat) {
+            throw std::runtime_error("not a shard manifest");
+        }
+        if (doc.at("/version").as<int>() != kVersion) {
+            throw std::runtime_error("unsupported manifest version");
+        }
+        manifest.seed = readCount(doc, "/seed");
+        manifest.rng = readString(doc, "/rng");
+        manifest.profile = readString(doc, "/profile");
+        manifest.profile_hash = readString(doc, "/profile_hash");
+        manifest.profile2 = readString(doc, "/profile2");
+        manifest.profile2_hash = readString(doc, "/profile2_hash");
+        manifest.exclude = readString(doc, "/exclude");
+        manifest.exclude_hash = readString(doc, "/exclude_hash");
+        manifest.strategy = readString(doc, "/strategy");
+        manifest.min_length = static_cast<uint64_t>(doc.at("/min_length").as<int>());
+        manifest.max_length = static_cast<uint64_t>(doc.at("/max_length").as<int>());
+        manifest.total_count = readCount(doc, "/total_count");
+        manifest.shard = static_cast<unsigned>(doc.at("/shard").as<int>());
+        manifest.shards = static_cast<unsigned>(doc.at("/shards").as<int>());
+        manifest.first_index = readCount(doc, "/first_index");
+        manifest.count = readCount(doc, "/count");
+        manifest.output = readString(doc, "/output");
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Invalid manifest " + path + ": " + e.what());
+    }
+
+    if (manifest.shards == 0 || manifest.shard == 0 || manifest.shard > manifest.shards) {
+        throw std::runtime_error("Invalid manifest " + path + ": bad shard number");
+    }
+    return manifest;
+}
+
+bool ShardManifest::sameJob(const ShardManifest& other) const {
+    // Profile paths may differ between machines; the hashes decide
+    return seed == other.seed && rng == other.rng &&
+           profile_hash == other.profile_hash && profile2_hash == other.profile2_hash &&
+           exclude_hash == other.exclude_hash && strategy == other.strategy &&
+           min_length == other.min_length && max_length == other.max_length &&
+           total_count == other.total_count && shards == other.shards;
+}
+
+uint64_t ShardManifest::shardBegin(uint64_t total_count, unsigned shard, unsigned shards) {
+    // total * (shard - 1) / shards without overflowing 64 bits
+    uint64_t before = shard - 1;
+    return total_count / shards * before + total_count % shards * before / shards;
+}
+
+std::string ShardManifest::hashFile(const std::string& path) {
+    MappedFile file(path);
+    uint64_t hash = UniqueNameSet::fingerprint(std::string_view(file.data(), file.size()));
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+    return buffer;
+}
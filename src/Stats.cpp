@@ -0,0 +1,117 @@
+#include "Stats.hpp"
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+const char* const kCounterNames[Stats::kCounterCount] = {
+    "profile_names", "legacy_names", "attempts", "length_rejects", "exclusion_rejects",
+    "attempts_exhausted", "constrained_names", "dead_ends", "error_fallbacks",
+    "strategy_fallbacks", "weighted_draws", "blocked_end_redraws", "bulk_names",
+    "unique_duplicates", "serve_requests", "serve_errors",
+};
+
+const char* const kTimerNames[Stats::kTimerCount] = {
+    "profile_load", "profile_blend", "stream_chunk", "serve_request",
+};
+
+struct Totals {
+    uint64_t counters[Stats::kCounterCount] = {};
+    uint64_t timer_calls[Stats::kTimerCount] = {};
+    uint64_t timer_ns[Stats::kTimerCount] = {};
+};
+
+} // namespace
+
+#if NAMEGEN_STATS
+
+namespace {
+
+// Blocks of live threads, plus the sums of threads that have exited
+struct Registry {
+    std::mutex mutex;
+    std::vector<const void*> live;
+    Totals retired;
+};
+
+Registry& registry() {
+    static Registry* instance = new Registry();  // Never destroyed: threads may exit after main
+    return *instance;
+}
+
+template <typename Block>
+void addTo(Totals& totals, const Block& block) {
+    for (unsigned i = 0; i < Stats::kCounterCount; ++i) {
+        totals.counters[i] += block.counters[i].load(std::memory_order_relaxed);
+    }
+    for (unsigned i = 0; i < Stats::kTimerCount; ++i) {
+        totals.timer_calls[i] += block.timer_calls[i].load(std::memory_order_relaxed);
+        totals.timer_ns[i] += block.timer_ns[i].load(std::memory_order_relaxed);
+    }
+}
+
+} // namespace
+
+Stats::ThreadStats& Stats::attachThread() {
+    // Owns the calling thread's block; folds it into the retired sums when
+    // the thread exits
+    struct Owner {
+        std::unique_ptr<ThreadStats> stats = std::make_unique<ThreadStats>();
+        Owner() {
+            Registry& shared = registry();
+            std::lock_guard<std::mutex> lock(shared.mutex);
+            shared.live.push_back(stats.get());
+        }
+        ~Owner() {
+            Registry& shared = registry();
+            std::lock_guard<std::mutex> lock(shared.mutex);
+            addTo(shared.retired, *stats);
+            std::erase(shared.live, static_cast<const void*>(stats.get()));
+            thread_stats_ = nullptr;
+        }
+    };
+    thread_local Owner owner;
+    thread_stats_ = owner.stats.get();
+    return *owner.stats;
+}
+
+#endif
+
+std::string Stats::toJson() {
+    Totals totals;
+#if NAMEGEN_STATS
+    {
+        Registry& shared = registry();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        totals = shared.retired;
+        for (const void* block : shared.live) {
+            addTo(totals, *static_cast<const ThreadStats*>(block));
+        }
+    }
+#endif
+
+    if (!enabled()) {
+        return "{\"enabled\": false}";
+    }
+
+    std::string json = "{\"enabled\": true, \"counters\": {";
+    char buffer[128];
+    for (unsigned i = 0; i < kCounterCount; ++i) {
+        std::snprintf(buffer, sizeof(buffer), "%s\"%s\": %llu", i > 0 ? ", " : "", kCounterNames[i],
+                      static_cast<unsigned long long>(totals.counters[i]));
+        json += buffer;
+    }
+    json += "}, \"timers\": {";
+    for (unsigned i = 0; i < kTimerCount; ++i) {
+        uint64_t calls = totals.timer_calls[i];
+        double total_ms = static_cast<double>(totals.timer_ns[i]) / 1e6;
+        std::snprintf(buffer, sizeof(buffer), "%s\"%s\": {\"calls\": %llu, \"total_ms\": %.3f, \"mean_us\": %.3f}",
+                      i > 0 ? ", " : "", kTimerNames[i], static_cast<unsigned long long>(calls), total_ms,
+                      calls > 0 ? total_ms * 1000 / static_cast<double>(calls) : 0.0);
+        json += buffer;
+    }
+    json += "}}";
+    return json;
+}
@@ -0,0 +1,90 @@
+#include "StringPool.hpp"
+#include "UniqueNameSet.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+StringPool::Ref StringPool::intern(std::string_view text) {
+    if (!index_.empty()) {
+        const Ref& existing = index_[slot(text)];
+        if (existing.id != kEmpty) {
+            return existing;
+        }
+    }
+    if (text.size() >= kEmpty - arena_.size()) {
+        throw std::length_error("StringPool: strings exceed 4 GiB");
+    }
+    Ref ref{static_cast<Id>(arena_.size()), static_cast<uint32_t>(text.size())};
+    arena_.append(text);
+    insert(ref);
+    return ref;
+}
+
+StringPool::Ref StringPool::find(std::string_view text) const {
+    if (index_.empty()) {
+        return Ref{kNotFound, 0};
+    }
+    return index_[slot(text)];  // kEmpty doubles as kNotFound
+}
+
+size_t StringPool::memoryUsage() const {
+    return arena_.capacity() + index_.capacity() * sizeof(Ref);
+}
+
+void StringPool::write(BinaryWriter& out) const {
+    // Entries in arena order, so the image doesn't depend on the index size
+    std::vector<Ref> entries;
+    entries.reserve(count_);
+    for (const Ref& ref : index_) {
+        if (ref.id != kEmpty) {
+            entries.push_back(ref);
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+
+    out.putString(arena_);
+    out.put(static_cast<uint32_t>(entries.size()));
+    out.putArray(std::span<const Ref>(entries));
+}
+
+StringPool StringPool::read(BinaryReader& in) {
+    StringPool pool;
+    pool.arena_ = std::string(in.getString());
+    uint32_t count = in.get<uint32_t>();
+    for (const Ref& ref : in.array<Ref>(count)) {
+        if (!pool.contains(ref)) {
+            throw std::runtime_error("Corrupt profile image: string out of bounds");
+        }
+        if (pool.find(pool.view(ref)).id == kNotFound) {
+            pool.insert(ref);
+        }
+    }
+    return pool;
+}
+
+size_t StringPool::slot(std::string_view text) const {
+    size_t mask = index_.size() - 1;
+    size_t i = UniqueNameSet::fingerprint(text) & mask;
+    while (index_[i].id != kEmpty && view(index_[i]) != text) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+void StringPool::insert(Ref ref) {
+    // Keep the index at most half full
+    if ((count_ + 1) * 2 > index_.size()) {
+        grow();
+    }
+    index_[slot(view(ref))] = ref;
+    ++count_;
+}
+
+void StringPool::grow() {
+    std::vector<Ref> old(std::max<size_t>(16, index_.size() * 2), Ref{kEmpty, 0});
+    old.swap(index_);
+    for (const Ref& ref : old) {
+        if (ref.id != kEmpty) {
+            index_[slot(view(ref))] = ref;
+        }
+    }
+}
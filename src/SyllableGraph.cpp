@@ -0,0 +1,170 @@
+#include "SyllableGraph.hpp"
+#include "ProfileData.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+
+namespace {
+
+using WeightedList = ProfileData::WeightedList;
+
+// Node with the given text, or kNoNode
+uint32_t nodeOf(const std::vector<StringPool::Ref>& nodes, StringPool::Ref ref) {
+    auto it = std::lower_bound(nodes.begin(), nodes.end(), ref);
+    return it != nodes.end() && *it == ref ? static_cast<uint32_t>(it - nodes.begin()) : SyllableGraph::kNoNode;
+}
+
+} // namespace
+
+SyllableGraph SyllableGraph::build(const ProfileData& profile) {
+    const StringPool& strings = profile.strings();
+    const WeightedList& starts = profile.getSyllablesStart();
+    const ProfileData::MarkovTable& order1 = profile.getSyllableMarkov1();
+    const ProfileData::MarkovTable& order2 = profile.getSyllableMarkov2();
+    bool use_pairs = profile.getMarkovOrder() >= 2;
+
+    SyllableGraph graph;
+
+    // Nodes: every syllable that can start a name, have successors or be one
+    for (const auto& item : starts.items()) {
+        graph.nodes_.push_back(item.value);
+    }
+    for (const auto& [context, list] : order1) {
+        graph.nodes_.push_back(context);
+        for (const auto& item : list.items()) {
+            graph.nodes_.push_back(item.value);
+        }
+    }
+    if (use_pairs) {
+        for (const auto& entry : order2) {
+            for (const auto& item : entry.second.items()) {
+                graph.nodes_.push_back(item.value);
+            }
+        }
+    }
+    std::sort(graph.nodes_.begin(), graph.nodes_.end());
+    graph.nodes_.erase(std::unique(graph.nodes_.begin(), graph.nodes_.end()), graph.nodes_.end());
+    graph.nodes_.shrink_to_fit();
+    const std::vector<StringPool::Ref>& nodes = graph.nodes_;
+    if (nodes.size() >= kNoNode) {
+        throw std::length_error("SyllableGraph: too many syllables");
+    }
+
+    auto node = [&](std::string_view text) {
+        StringPool::Ref ref = strings.find(text);
+        return ref.id == StringPool::kNotFound ? kNoNode : nodeOf(nodes, ref);
+    };
+
+    // Same items in the same order as the list, so draws match it
+    std::vector<uint64_t> weights;
+    for (const auto& item : starts.items()) {
+        graph.start_nodes_.push_back(nodeOf(nodes, item.value));
+        weights.push_back(item.weight > 0 ? static_cast<uint64_t>(item.weight) : 0);
+        graph.start_weights_.push_back(static_cast<uint32_t>(weights.back()));
+    }
+    graph.start_sampler_ = AliasTable(weights);
+
+    // Pair contexts whose syllables are both nodes
+    std::vector<std::tuple<uint32_t, uint32_t, const WeightedList*>> pairs;  // (previous, current, list)
+    if (use_pairs) {
+        for (const auto& [context, list] : order2) {
+            std::string_view key = strings.view(context);
+            size_t split = key.find_first_of("| ");
+            uint32_t previous = kNoNode;
+            uint32_t current = kNoNode;
+            if (split != std::string_view::npos) {
+                previous = node(key.substr(0, split));
+                current = node(key.substr(split + 1));
+            } else {
+                for (split = 1; split < key.size() && (previous == kNoNode || current == kNoNode); ++split) {
+                    previous = node(key.substr(0, split));
+                    current = node(key.substr(split));
+                }
+            }
+            if (previous != kNoNode && current != kNoNode) {
+                pairs.emplace_back(previous, current, &list);
+            }
+        }
+        std::sort(pairs.begin(), pairs.end(), [](const auto& a, const auto& b) {
+            return std::tie(std::get<0>(a), std::get<1>(a)) < std::tie(std::get<0>(b), std::get<1>(b));
+        });
+        pairs.erase(std::unique(pairs.begin(), pairs.end(), [](const auto& a, const auto& b) {
+            return std::get<0>(a) == std::get<0>(b) && std::get<1>(a) == std::get<1>(b);
+        }), pairs.end());
+    }
+
+    graph.pair_offsets_.assign(nodes.size() + 1, 0);
+    graph.pair_second_.reserve(pairs.size());
+    for (const auto& pair : pairs) {
+        ++graph.pair_offsets_[std::get<0>(pair) + 1];
+        graph.pair_second_.push_back(std::get<1>(pair));
+    }
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        graph.pair_offsets_[i + 1] += graph.pair_offsets_[i];
+    }
+
+    // Rows in order: one per node, then one per pair
+    std::vector<const WeightedList*> rows(nodes.size(), nullptr);
+    for (const auto& [context, list] : order1) {
+        rows[nodeOf(nodes, context)] = &list;
+    }
+    for (const auto& pair : pairs) {
+        rows.push_back(std::get<2>(pair));
+    }
+
+    // Size the edge arrays once; they are the bulk of the graph
+    size_t edges = 0;
+    for (const WeightedList* list : rows) {
+        edges += list ? list->size() : 0;
+    }
+    if (edges >= UINT32_MAX) {
+        throw std::length_error("SyllableGraph: too many transitions");
+    }
+    graph.next_.reserve(edges);
+    graph.weights_.reserve(edges);
+    graph.threshold_.reserve(edges);
+    graph.alias_.reserve(edges);
+    graph.totals_.reserve(rows.size());
+    graph.row_offsets_.reserve(rows.size() + 1);
+    graph.row_offsets_.push_back(0);
+    for (const WeightedList* list : rows) {
+        size_t begin = graph.next_.size();
+        if (list) {
+            weights.clear();
+            for (const auto& item : list->items()) {
+                graph.next_.push_back(nodeOf(nodes, item.value));
+                weights.push_back(item.weight > 0 ? static_cast<uint64_t>(item.weight) : 0);
+                graph.weights_.push_back(static_cast<uint32_t>(weights.back()));
+            }
+        }
+        graph.threshold_.resize(graph.next_.size());
+        graph.alias_.resize(graph.next_.size());
+        size_t count = graph.next_.size() - begin;
+        graph.totals_.push_back(count == 0 ? 0 :
+            AliasTable::build(weights, std::span<uint64_t>(graph.threshold_).subspan(begin, count),
+                              std::span<uint32_t>(graph.alias_).subspan(begin, count)));
+        graph.row_offsets_.push_back(static_cast<uint32_t>(graph.next_.size()));
+    }
+    return graph;
+}
+
+uint32_t SyllableGraph::findNode(const StringPool& strings, std::string_view text) const {
+    StringPool::Ref ref = strings.find(text);
+    return ref.id == StringPool::kNotFound ? kNoNode : nodeOf(nodes_, ref);
+}
+
+uint32_t SyllableGraph::findPair(uint32_t previous, uint32_t current) const {
+    auto begin = pair_second_.begin() + pair_offsets_[previous];
+    auto end = pair_second_.begin() + pair_offsets_[previous + 1];
+    auto it = std::lower_bound(begin, end, current);
+    return it != end && *it == current ? static_cast<uint32_t>(it - pair_second_.begin()) : kNoNode;
+}
+
+size_t SyllableGraph::memoryUsage() const {
+    return nodes_.capacity() * sizeof(StringPool::Ref) +
+           (start_nodes_.capacity() + start_weights_.capacity()) * sizeof(uint32_t) +
+           start_sampler_.size() * (sizeof(uint64_t) + sizeof(uint32_t)) +
+           (pair_offsets_.capacity() + pair_second_.capacity() + row_offsets_.capacity() +
+            next_.capacity() + weights_.capacity() + alias_.capacity()) * sizeof(uint32_t) +
+           (totals_.capacity() + threshold_.capacity()) * sizeof(uint64_t);
+}
@@ -0,0 +1,67 @@
+#include "UniqueNameSet.hpp"
+#include <stdexcept>
+
+namespace {
+
+// Keep the table at most 3/4 full so probe sequences stay short
+constexpr uint64_t kLoadNumerator = 3;
+constexpr uint64_t kLoadDenominator = 4;
+
+uint64_t mix(uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+} // namespace
+
+UniqueNameSet::UniqueNameSet(uint64_t expected_names) {
+    uint64_t wanted = expected_names / kLoadNumerator * kLoadDenominator + kLoadDenominator;
+    uint64_t capacity = 1024;
+    while (capacity < wanted) {
+        capacity <<= 1;
+    }
+
+    slots_ = std::make_unique<std::atomic<uint64_t>[]>(capacity);
+    for (uint64_t i = 0; i < capacity; ++i) {
+        slots_[i].store(0, std::memory_order_relaxed);
+    }
+    mask_ = capacity - 1;
+    max_size_ = capacity / kLoadDenominator * kLoadNumerator;
+}
+
+uint64_t UniqueNameSet::fingerprint(std::string_view name) {
+    // FNV-1a, then a finalizer so short names spread over all 64 bits
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (char c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001B3ULL;
+    }
+    hash = mix(hash);
+    return hash != 0 ? hash : 1;
+}
+
+bool UniqueNameSet::insert(uint64_t fingerprint) {
+    uint64_t index = mix(fingerprint) & mask_;
+
+    for (;;) {
+        uint64_t current = slots_[index].load(std::memory_order_acquire);
+        if (current == fingerprint) {
+            return false;
+        }
+        if (current == 0) {
+            if (size_.load(std::memory_order_relaxed) >= max_size_) {
+                throw std::length_error("UniqueNameSet is full");
+            }
+            if (slots_[index].compare_exchange_strong(current, fingerprint, std::memory_order_acq_rel)) {
+                size_.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            // Lost the race; `current` now holds the winner, check it again
+            if (current == fingerprint) {
+                return false;
+            }
+        }
+        index = (index + 1) & mask_;
+    }
+}
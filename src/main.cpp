@@ -1,23 +1,70 @@
 #include "NameGenerator.hpp"
+#include "OutputWriter.hpp"
+#include "NameServer.hpp"
+#include "NameEnumerator.hpp"
+#include "NameMerger.hpp"
+#include "ProfileAnalyzer.hpp"
+#include "ShardManifest.hpp"
+#include "Stats.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <cstdlib>
+#include <utility>
+#include <vector>
 
 void printUsage(const char* programName) {
     std::cout << "Usage: " << programName << " [count] [options]\n"
+              << "       " << programName << " compile <profile.json> [-o <profile.ngp>]\n"
+              << "       " << programName << " compile --exclude <words.txt> [-o <words.ngx>]\n"
+              << "       " << programName << " serve (--socket <path> | --port <n>) [--profile [name=]<file>]...\n"
+              << "                             [--profile-dir <dir>] [--memory-budget <MiB>] [--threads <n>]\n"
+              << "                             [--reload-interval <seconds>]\n"
+              << "       " << programName << " merge [--unique] [--memory <MiB>] [-o <file>] <shard files>...\n"
+              << "       " << programName << " analyze (--profile <file> | --blend <spec>) [--strategy <name>]\n"
+              << "                             [--min-length <n>] [--max-length <n>] [--top <k>]\n"
+              << "                             [--draws <n,...>] [--threads <n>]\n"
+              << "       " << programName << " enumerate <count> (--profile <file> | --blend <spec>) [--strategy <name>]\n"
+              << "                             [--min-length <n>] [--max-length <n>] [--memory <MiB>]\n"
+              << "                             [--probabilities] [-o <file>]\n"
               << "\n"
               << "Arguments:\n"
-              << "  count                   Number of names to generate (default: 10)\n"
+              << "  count                   Number of names to generate (default: 10, no upper limit)\n"
               << "\n"
               << "Options:\n"
-              << "  --profile <file>        Load NameAnalyzer JSON profile\n"
+              << "  --profile <file>        Load NameAnalyzer JSON profile or compiled .ngp image\n"
               << "  --profile2 <file>       Load second profile for blending (optional)\n"
+              << "  --blend <file:w,...>    Mix several profiles by weight into one\n"
+              << "                          (instead of --profile)\n"
               << "  --strategy <name>       Generation strategy (default: markov2)\n"
               << "                          Strategies: markov1, markov2, syllable,\n"
               << "                                     component, ngram, random, legacy\n"
               << "  --min-length <n>        Minimum name length (default: unbounded)\n"
               << "  --max-length <n>        Maximum name length (default: unbounded)\n"
+              << "  -o, --output <file>     Write names to a file instead of stdout\n"
+              << "  --unique                Only output distinct names\n"
+              << "  --bulk                  Fastest Markov output for large datasets: walks\n"
+              << "                          many names in lockstep (markov1/markov2 without\n"
+              << "                          blending, length bounds or exclusions)\n"
+              << "  --exclude <file>        Never output names on this list (one per line,\n"
+              << "                          case-insensitive, or a compiled .ngx list)\n"
+              << "  --seed <n>              Seed for reproducible output (default: random)\n"
+              << "  --start <index>         Begin at name number <index> of the seed's sequence,\n"
+              << "                          e.g. to resume a run (default: 0)\n"
+              << "  --shard <i/N>           Generate only part i of N of the count (needs --seed);\n"
+              << "                          writes a manifest next to the -o file for merge\n"
+              << "  --manifest <file>       Where to write the shard manifest\n"
+              << "  --rng <engine>          Random engine: xoshiro256pp (default), pcg64,\n"
+              << "                          philox, mt19937\n"
+              << "  --threads <n>           Worker threads, 0 = one per core (default: 1)\n"
+              << "                          Output for a given seed is the same for any thread\n"
+              << "                          count\n"
               << "  --debug, -d             Show strategy/pattern used for each name\n"
+              << "  --stats                 Print generation counters as JSON to stderr at exit\n"
               << "  --help, -h              Show this help message\n"
               << "\n"
               << "Examples:\n"
@@ -30,17 +77,564 @@ void printUsage(const char* programName) {
               << "\n"
               << "Profile Blending:\n"
               << "  " << programName << " 20 --profile norse.json --profile2 japanese.json\n"
-              << "  " << programName << " 15 --profile greek.json --profile2 egyptian.json --strategy syllable\n";
+              << "  " << programName << " 15 --profile greek.json --profile2 egyptian.json --strategy syllable\n"
+              << "\n"
+              << "Compiled Profiles:\n"
+              << "  " << programName << " compile greek.json -o greek.ngp    # Precompile once\n"
+              << "  " << programName << " 20 --profile greek.ngp              # Loads without JSON parsing\n"
+              << "  " << programName << " compile --exclude words.txt -o words.ngx\n"
+              << "\n"
+              << "Server Mode:\n"
+              << "  " << programName << " serve --socket /tmp/namegen.sock --profile greek.ngp --profile norse=norse.ngp\n"
+              << "  Requests, one per line: GEN 10 profile=greek strategy=markov2 min=4 max=8\n"
+              << "\n"
+              << "Sharded Runs:\n"
+              << "  " << programName << " 1000000 --profile greek.ngp --seed 42 --shard 1/2 -o part1.txt\n"
+              << "  " << programName << " 1000000 --profile greek.ngp --seed 42 --shard 2/2 -o part2.txt\n"
+              << "  " << programName << " merge --unique part1.txt part2.txt -o names.txt\n"
+              << "\n"
+              << "Output Analysis:\n"
+              << "  " << programName << " analyze --profile greek.ngp --strategy markov2 --min-length 4 --max-length 8\n"
+              << "  Length distribution, entropy, name count, expected distinct names and top names\n"
+              << "  " << programName << " enumerate 1000000 --profile greek.ngp -o reserved.txt   # Most likely names first\n";
+}
+
+int runCompile(int argc, char* argv[]) {
+    std::string input_path;
+    std::string output_path;
+    bool exclusion_list = false;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--exclude") {
+            exclusion_list = true;
+        } else if (arg == "-o" || arg == "--output") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << arg << " requires a file path\n";
+                return 1;
+            }
+            output_path = argv[++i];
+        } else if (input_path.empty()) {
+            input_path = arg;
+        } else {
+            std::cerr << "Error: Unexpected argument '" << arg << "'\n";
+            return 1;
+        }
+    }
+
+    if (input_path.empty()) {
+        std::cerr << "Error: compile requires an input path\n";
+        return 1;
+    }
+
+    // Default output: same name with a .ngp extension
+    if (output_path.empty()) {
+        size_t dot = input_path.find_last_of('.');
+        size_t slash = input_path.find_last_of("/\\");
+        bool has_extension = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+        output_path = (has_extension ? input_path.substr(0, dot) : input_path) +
+                      (exclusion_list ? ".ngx" : ".ngp");
+    }
+
+    try {
+        if (exclusion_list) {
+            ExclusionTrie::load(input_path).save(output_path);
+        } else {
+            ProfileData profile(input_path);
+            profile.saveCompiled(output_path);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error compiling " << input_path << ": " << e.what() << '\n';
+        return 1;
+    }
+
+    std::cerr << "Compiled " << input_path << " -> " << output_path << '\n';
+    return 0;
+}
+
+int runServe(int argc, char* argv[]) {
+    ServerOptions options;
+    std::vector<std::pair<std::string, std::string>> profiles;  // (name, path)
+    std::vector<std::string> directories;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Error: Unexpected argument '" << arg << "'\n";
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--socket") {
+            options.socket_path = value;
+        } else if (arg == "--port") {
+            try {
+                unsigned long port = std::stoul(value);
+                if (port == 0 || port > 65535) {
+                    throw std::out_of_range("port");
+                }
+                options.port = static_cast<uint16_t>(port);
+            } catch (const std::exception&) {
+                std::cerr << "Error: Invalid port value\n";
+                return 1;
+            }
+        } else if (arg == "--threads") {
+            try {
+                unsigned long threads = std::stoul(value);
+                if (threads > 1024) {
+                    std::cerr << "Error: Thread count is too large (max 1024)\n";
+                    return 1;
+                }
+                options.threads = static_cast<unsigned>(threads);
+            } catch (const std::exception&) {
+                std::cerr << "Error: Invalid threads value\n";
+                return 1;
+            }
+        } else if (arg == "--reload-interval") {
+            try {
+                unsigned long seconds = std::stoul(value);
+                if (seconds > 86400) {
+                    throw std::out_of_range("reload-interval");
+                }
+                options.reload_interval = static_cast<unsigned>(seconds);
+            } catch (const std::exception&) {
+                std::cerr << "Error: Invalid reload-interval value\n";
+                return 1;
+            }
+        } else if (arg == "--profile-dir") {
+            directories.push_back(value);
+        } else if (arg == "--memory-budget") {
+            try {
+                options.memory_budget = static_cast<size_t>(std::stoull(value)) << 20;
+            } catch (const std::exception&) {
+                std::cerr << "Error: Invalid memory-budget value\n";
+                return 1;
+            }
+        } else if (arg == "--profile") {
+            // name=path, or just a path named after its file
+            size_t equals = value.find('=');
+            if (equals != std::string::npos) {
+                profiles.emplace_back(value.substr(0, equals), value.substr(equals + 1));
+            } else {
+                size_t slash = value.find_last_of("/\\");
+                std::string name = slash == std::string::npos ? value : value.substr(slash + 1);
+                profiles.emplace_back(name.substr(0, name.find_last_of('.')), value);
+            }
+        } else {
+            std::cerr << "Error: Unexpected argument '" << arg << "'\n";
+            return 1;
+        }
+    }
+
+    if (options.socket_path.empty() == (options.port == 0)) {
+        std::cerr << "Error: serve requires either --socket or --port\n";
+        return 1;
+    }
+
+    try {
+        NameServer server(options);
+        // Profiles load on first use
+        for (const std::string& directory : directories) {
+            size_t found = server.addProfileDirectory(directory);
+            std::cerr << "Found " << found << " profiles in " << directory << '\n';
+        }
+        for (const auto& [name, path] : profiles) {
+            server.addProfile(name, path);
+        }
+        std::cerr << "Listening on "
+                  << (options.socket_path.empty() ? "127.0.0.1:" + std::to_string(options.port) : options.socket_path)
+                  << '\n';
+        server.run();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
+
+int runMerge(int argc, char* argv[]) {
+    std::vector<std::string> inputs;
+    std::string output_path;
+    bool unique = false;
+    size_t memory_budget = NameMerger::kDefaultMemoryBudget;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--unique") {
+            unique = true;
+        } else if (arg == "-o" || arg == "--output") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << arg << " requires a file path\n";
+                return 1;
+            }
+            output_path = argv[++i];
+        } else if (arg == "--memory") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --memory requires a number\n";
+                return 1;
+            }
+            try {
+                memory_budget = static_cast<size_t>(std::stoull(argv[++i])) << 20;
+                if (memory_budget == 0) {
+                    throw std::out_of_range("memory");
+                }
+            } catch (const std::exception&) {
+                std::cerr << "Error: Invalid memory value\n";
+                return 1;
+            }
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+
+    if (inputs.empty()) {
+        std::cerr << "Error: merge requires input files\n";
+        return 1;
+    }
+
+    try {
+        // Shards with manifests must all come from one job, and all of them
+        // must be present; they are then taken in shard order
+        std::vector<ShardManifest> manifests;
+        for (const std::string& input : inputs) {
+            std::string manifest_path = ShardManifest::pathFor(input);
+            if (std::filesystem::exists(manifest_path)) {
+                manifests.push_back(ShardManifest::load(manifest_path));
+            }
+        }
+        if (!manifests.empty()) {
+            if (manifests.size() != inputs.size()) {
+                throw std::runtime_error("some inputs have shard manifests and some don't");
+            }
+            std::vector<size_t> order(inputs.size());
+            std::vector<bool> seen(manifests[0].shards + 1, false);
+            for (size_t i = 0; i < manifests.size(); ++i) {
+                const ShardManifest& manifest = manifests[i];
+                if (!manifest.sameJob(manifests[0])) {
+                    throw std::runtime_error(inputs[i] + " belongs to a different job than " + inputs[0]);
+                }
+                if (seen[manifest.shard]) {
+                    throw std::runtime_error("shard " + std::to_string(manifest.shard) + " is given twice");
+                }
+                seen[manifest.shard] = true;
+                order[i] = i;
+            }
+            if (inputs.size() != manifests[0].shards) {
+                throw std::runtime_error("only " + std::to_string(inputs.size()) + " of " +
+                                         std::to_string(manifests[0].shards) + " shards given");
+            }
+            std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+                return manifests[a].shard < manifests[b].shard;
+            });
+            std::vector<std::string> sorted;
+            for (size_t index : order) {
+                sorted.push_back(inputs[index]);
+            }
+            inputs = std::move(sorted);
+        }
+
+        std::unique_ptr<OutputWriter> out = output_path.empty() ?
+            std::make_unique<OutputWriter>(1) : std::make_unique<OutputWriter>(output_path);
+        NameMerger merger(memory_budget);
+        uint64_t lines = unique ? merger.mergeUnique(inputs, *out) : merger.concatenate(inputs, *out);
+        out->flush();
+        std::cerr << "Merged " << inputs.size() << " files, " << lines << " names\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
+
+int runAnalyze(int argc, char* argv[]) {
+    std::string profile_path;
+    std::string blend_spec;
+    GenerationStrategy strategy = GenerationStrategy::Markov2;
+    AnalysisOptions options;
+    options.draws = {1000, 10000, 100000, 1000000, 10000000};
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Error: Unexpected argument '" << arg << "'\n";
+            return 1;
+        }
+        std::string value = argv[++i];
+        try {
+            if (arg == "--profile") {
+                profile_path = value;
+            } else if (arg == "--blend") {
+                blend_spec = value;
+            } else if (arg == "--strategy") {
+                if (!NameGenerator::parseStrategy(value, strategy)) {
+                    std::cerr << "Error: Unknown strategy '" << value << "'\n";
+                    return 1;
+                }
+            } else if (arg == "--min-length") {
+                options.min_length = std::stoull(value);
+            } else if (arg == "--max-length") {
+                options.max_length = std::stoull(value);
+            } else if (arg == "--top") {
+                options.top = std::stoull(value);
+            } else if (arg == "--threads") {
+                unsigned long threads = std::stoul(value);
+                if (threads > 1024) {
+                    std::cerr << "Error: Thread count is too large (max 1024)\n";
+                    return 1;
+                }
+                options.threads = static_cast<unsigned>(threads);
+            } else if (arg == "--draws") {
+                options.draws.clear();
+                for (size_t begin = 0; begin <= value.size();) {
+                    size_t comma = std::min(value.find(',', begin), value.size());
+                    options.draws.push_back(std::stoull(value.substr(begin, comma - begin)));
+                    begin = comma + 1;
+                }
+            } else {
+                std::cerr << "Error: Unexpected argument '" << arg << "'\n";
+                return 1;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Error: Invalid " << arg.substr(2) << " value\n";
+            return 1;
+        }
+    }
+
+    if (profile_path.empty() == blend_spec.empty()) {
+        std::cerr << "Error: analyze requires either --profile or --blend\n";
+        return 1;
+    }
+
+    try {
+        std::shared_ptr<const ProfileData> profile;
+        if (blend_spec.empty()) {
+            profile = std::make_shared<const ProfileData>(profile_path);
+        } else {
+            std::vector<ProfileData::BlendComponent> components;
+            for (const auto& [path, weight] : ProfileData::parseBlendSpec(blend_spec)) {
+                components.push_back({std::make_shared<const ProfileData>(path), weight});
+            }
+            profile = ProfileData::blend(components);
+        }
+
+        ProfileAnalysis analysis = ProfileAnalyzer::analyze(*profile, strategy, options);
+
+        char line[128];
+        std::cout << "Profile:        " << (blend_spec.empty() ? profile_path : blend_spec) << '\n'
+                  << "Strategy:       " << NameGenerator::strategyName(analysis.strategy) << '\n';
+        if (options.min_length > 0 || options.max_length > 0) {
+            std::snprintf(line, sizeof(line), "%.4g%% of unbounded walks fit", analysis.in_bounds * 100.0);
+            std::cout << "Length bounds:  " << options.min_length << '-'
+                      << (options.max_length > 0 ? std::to_string(options.max_length) : "") << " (" << line << ")\n";
+        }
+        std::snprintf(line, sizeof(line), "%.6g", analysis.names);
+        std::cout << "Distinct names: " << line << '\n';
+        std::snprintf(line, sizeof(line), "%.3f bits per name", analysis.entropy);
+        std::cout << "Entropy:        " << line << '\n';
+
+        std::cout << "\nLength distribution:\n";
+        for (size_t length = 0; length < analysis.length_probability.size(); ++length) {
+            if (analysis.length_probability[length] > 0.0) {
+                std::snprintf(line, sizeof(line), "  %6zu  %.6f", length, analysis.length_probability[length]);
+                std::cout << line << '\n';
+            }
+        }
+
+        if (!analysis.expected_distinct.empty()) {
+            std::cout << "\nExpected distinct names:\n";
+            for (const auto& [draws, expected] : analysis.expected_distinct) {
+                std::snprintf(line, sizeof(line), "  %12llu draws  %.6g (%.2f%%)",
+                              static_cast<unsigned long long>(draws), expected,
+                              draws > 0 ? expected / static_cast<double>(draws) * 100.0 : 100.0);
+                std::cout << line << '\n';
+            }
+        }
+
+        if (!analysis.top.empty()) {
+            std::cout << "\nMost likely names:\n";
+            for (const auto& [name, probability] : analysis.top) {
+                std::snprintf(line, sizeof(line), "  %.6g", probability);
+                std::cout << line << "  " << name << '\n';
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
+
+int runEnumerate(int argc, char* argv[]) {
+    uint64_t count = 0;
+    std::string profile_path;
+    std::string blend_spec;
+    std::string output_path;
+    GenerationStrategy strategy = GenerationStrategy::Markov2;
+    size_t min_length = 0;
+    size_t max_length = 0;
+    size_t memory_budget = NameEnumerator::kDefaultMemoryBudget;
+    bool probabilities = false;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--probabilities") {
+            probabilities = true;
+            continue;
+        }
+        if (arg.rfind("-", 0) != 0) {
+            try {
+                count = std::stoull(arg);
+            } catch (const std::exception&) {
+                std::cerr << "Error: Invalid count '" << arg << "'\n";
+                return 1;
+            }
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Error: " << arg << " requires a value\n";
+            return 1;
+        }
+        std::string value = argv[++i];
+        try {
+            if (arg == "--profile") {
+                profile_path = value;
+            } else if (arg == "--blend") {
+                blend_spec = value;
+            } else if (arg == "-o" || arg == "--output") {
+                output_path = value;
+            } else if (arg == "--strategy") {
+                if (!NameGenerator::parseStrategy(value, strategy)) {
+                    std::cerr << "Error: Unknown strategy '" << value << "'\n";
+                    return 1;
+                }
+            } else if (arg == "--min-length") {
+                min_length = std::stoull(value);
+            } else if (arg == "--max-length") {
+                max_length = std::stoull(value);
+            } else if (arg == "--memory") {
+                memory_budget = static_cast<size_t>(std::stoull(value)) << 20;
+                if (memory_budget == 0) {
+                    throw std::out_of_range("memory");
+                }
+            } else {
+                std::cerr << "Error: Unexpected argument '" << arg << "'\n";
+                return 1;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Error: Invalid " << arg.substr(arg.find_first_not_of('-')) << " value\n";
+            return 1;
+        }
+    }
+
+    if (count == 0) {
+        std::cerr << "Error: enumerate requires a count greater than 0\n";
+        return 1;
+    }
+    if (profile_path.empty() == blend_spec.empty()) {
+        std::cerr << "Error: enumerate requires either --profile or --blend\n";
+        return 1;
+    }
+
+    try {
+        std::shared_ptr<const ProfileData> profile;
+        if (blend_spec.empty()) {
+            profile = std::make_shared<const ProfileData>(profile_path);
+        } else {
+            std::vector<ProfileData::BlendComponent> components;
+            for (const auto& [path, weight] : ProfileData::parseBlendSpec(blend_spec)) {
+                components.push_back({std::make_shared<const ProfileData>(path), weight});
+            }
+            profile = ProfileData::blend(components);
+        }
+
+        // Probabilities are printed as shares of the names generated with
+        // these bounds
+        double in_bounds = 1.0;
+        if (probabilities) {
+            AnalysisOptions options;
+            options.min_length = min_length;
+            options.max_length = max_length;
+            options.top = 0;
+            options.threads = 0;
+            in_bounds = ProfileAnalyzer::analyze(*profile, strategy, options).in_bounds;
+        }
+
+        std::unique_ptr<OutputWriter> out = output_path.empty() ?
+            std::make_unique<OutputWriter>(1) : std::make_unique<OutputWriter>(output_path);
+        NameEnumerator enumerator(*profile, strategy, min_length, max_length, memory_budget);
+        std::string name;
+        std::string line;
+        double probability;
+        uint64_t listed = 0;
+        char number[32];
+        while (listed < count && enumerator.next(name, probability)) {
+            line = name;
+            if (probabilities) {
+                std::snprintf(number, sizeof(number), "\t%.6g", probability / in_bounds);
+                line += number;
+            }
+            line += '\n';
+            out->write(line);
+            ++listed;
+        }
+        out->flush();
+
+        if (listed < count) {
+            if (enumerator.truncated()) {
+                std::cerr << "Warning: memory budget reached after " << listed
+                          << " names (all names above probability " << enumerator.cutoff() / in_bounds
+                          << " were listed); raise --memory for more\n";
+            } else if (listed == 0) {
+                std::cerr << "Warning: no name from this profile fits the length bounds\n";
+            } else {
+                std::cerr << "Note: the profile has only " << listed << " names\n";
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
 }
 
 int main(int argc, char* argv[]) {
-    size_t count = 10;
+    uint64_t count = 10;
     bool debug = false;
     std::string profile_path;
     std::string profile2_path;
+    std::string blend_spec;
     GenerationStrategy strategy = GenerationStrategy::Markov2;
     size_t min_length = 0;
     size_t max_length = 0;
+    unsigned threads = 1;
+    bool has_seed = false;
+    uint64_t seed = 0;
+    RngKind rng_kind = RngKind::Xoshiro256pp;
+    std::string output_path;
+    bool unique = false;
+    bool bulk = false;
+    bool stats = false;
+    uint64_t start_index = 0;
+    unsigned shard = 0;
+    unsigned shards = 0;
+    std::string manifest_path;
+    std::string exclude_path;
+
+    // Subcommands
+    if (argc > 1 && std::string(argv[1]) == "compile") {
+        return runCompile(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "serve") {
+        return runServe(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "merge") {
+        return runMerge(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "analyze") {
+        return runAnalyze(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "enumerate") {
+        return runEnumerate(argc, argv);
+    }
 
     // Parse command line arguments
     for (int i = 1; i < argc; ++i) {
@@ -51,12 +645,30 @@ int main(int argc, char* argv[]) {
             return 0;
         } else if (arg == "--debug" || arg == "-d") {
             debug = true;
+        } else if (arg == "--unique") {
+            unique = true;
+        } else if (arg == "--bulk") {
+            bulk = true;
+        } else if (arg == "--stats") {
+            stats = true;
+        } else if (arg == "--exclude") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --exclude requires a file path\n";
+                return 1;
+            }
+            exclude_path = argv[++i];
         } else if (arg == "--profile") {
             if (i + 1 >= argc) {
                 std::cerr << "Error: --profile requires a file path\n";
                 return 1;
             }
             profile_path = argv[++i];
+        } else if (arg == "--blend") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --blend requires a list of profiles\n";
+                return 1;
+            }
+            blend_spec = argv[++i];
         } else if (arg == "--profile2") {
             if (i + 1 >= argc) {
                 std::cerr << "Error: --profile2 requires a file path\n";
@@ -68,23 +680,8 @@ int main(int argc, char* argv[]) {
                 std::cerr << "Error: --strategy requires a strategy name\n";
                 return 1;
             }
-            std::string strategy_name = argv[++i];
-            if (strategy_name == "markov1") {
-                strategy = GenerationStrategy::Markov1;
-            } else if (strategy_name == "markov2") {
-                strategy = GenerationStrategy::Markov2;
-            } else if (strategy_name == "syllable") {
-                strategy = GenerationStrategy::Syllable;
-            } else if (strategy_name == "component") {
-                strategy = GenerationStrategy::Component;
-            } else if (strategy_name == "ngram") {
-                strategy = GenerationStrategy::NGram;
-            } else if (strategy_name == "random") {
-                strategy = GenerationStrategy::Random;
-            } else if (strategy_name == "legacy") {
-                strategy = GenerationStrategy::Legacy;
-            } else {
-                std::cerr << "Error: Unknown strategy '" << strategy_name << "'\n";
+            if (!NameGenerator::parseStrategy(argv[++i], strategy)) {
+                std::cerr << "Error: Unknown strategy '" << argv[i] << "'\n";
                 std::cerr << "Valid strategies: markov1, markov2, syllable, component, ngram, random, legacy\n";
                 return 1;
             }
@@ -110,6 +707,89 @@ int main(int argc, char* argv[]) {
                 std::cerr << "Error: Invalid max-length value\n";
                 return 1;
             }
+        } else if (arg == "-o" || arg == "--output") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << arg << " requires a file path\n";
+                return 1;
+            }
+            output_path = argv[++i];
+        } else if (arg == "--threads") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --threads requires a number\n";
+                return 1;
+            }
+            try {
+                unsigned long value = std::stoul(argv[++i]);
+                if (value > 1024) {
+                    std::cerr << "Error: Thread count is too large (max 1024)\n";
+                    return 1;
+                }
+                threads = static_cast<unsigned>(value);
+            } catch (const std::exception&) {
+                std::cerr << "Error: Invalid threads value\n";
+                return 1;
+            }
+        } else if (arg == "--seed") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --seed requires a number\n";
+                return 1;
+            }
+            try {
+                seed = std::stoull(argv[++i]);
+                has_seed = true;
+            } catch (const std::exception&) {
+                std::cerr << "Error: Invalid seed value\n";
+                return 1;
+            }
+        } else if (arg == "--start") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --start requires a number\n";
+                return 1;
+            }
+            try {
+                start_index = std::stoull(argv[++i]);
+            } catch (const std::exception&) {
+                std::cerr << "Error: Invalid start value\n";
+                return 1;
+            }
+        } else if (arg == "--shard") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --shard requires i/N\n";
+                return 1;
+            }
+            std::string value = argv[++i];
+            size_t slash = value.find('/');
+            try {
+                if (slash == std::string::npos) {
+                    throw std::invalid_argument("shard");
+                }
+                unsigned long index = std::stoul(value.substr(0, slash));
+                unsigned long total = std::stoul(value.substr(slash + 1));
+                if (index == 0 || index > total || total > 1000000) {
+                    throw std::out_of_range("shard");
+                }
+                shard = static_cast<unsigned>(index);
+                shards = static_cast<unsigned>(total);
+            } catch (const std::exception&) {
+                std::cerr << "Error: Invalid shard '" << value << "' (expected i/N with 1 <= i <= N)\n";
+                return 1;
+            }
+        } else if (arg == "--manifest") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --manifest requires a file path\n";
+                return 1;
+            }
+            manifest_path = argv[++i];
+        } else if (arg == "--rng") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --rng requires an engine name\n";
+                return 1;
+            }
+            if (!Rng::parseKind(argv[++i], rng_kind)) {
+                std::cerr << "Error: Unknown RNG '" << argv[i] << "'\n";
+                std::cerr << "Valid engines: xoshiro256pp, pcg64, philox, mt19937\n";
+                return 1;
+            }
         } else {
             // Try to parse as count
             try {
@@ -118,10 +798,6 @@ int main(int argc, char* argv[]) {
                     std::cerr << "Error: Count must be greater than 0\n";
                     return 1;
                 }
-                if (count > 10000) {
-                    std::cerr << "Error: Count is too large (max 10000)\n";
-                    return 1;
-                }
             } catch (const std::exception&) {
                 std::cerr << "Error: Invalid argument '" << arg << "'\n";
                 printUsage(argv[0]);
@@ -130,13 +806,68 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    if (bulk && start_index > 0) {
+        std::cerr << "Error: --bulk output can't start at an index; drop --bulk to use --start\n";
+        return 1;
+    }
+
+    uint64_t name_count = count;
+    if (shards > 0) {
+        // Shards must give the same names on every machine, and duplicates
+        // across shards are removed by merge
+        if (!has_seed) {
+            std::cerr << "Error: --shard requires --seed\n";
+            return 1;
+        }
+        if (unique || bulk || start_index > 0) {
+            std::cerr << "Error: --shard can't be combined with --unique, --bulk or --start "
+                         "(use merge --unique to drop duplicates)\n";
+            return 1;
+        }
+        start_index = ShardManifest::shardBegin(count, shard, shards);
+        name_count = ShardManifest::shardBegin(count, shard + 1, shards) - start_index;
+        if (manifest_path.empty() && !output_path.empty()) {
+            manifest_path = ShardManifest::pathFor(output_path);
+        }
+    } else if (!manifest_path.empty()) {
+        std::cerr << "Error: --manifest requires --shard\n";
+        return 1;
+    }
+
     // Create generator
     NameGenerator generator;
+    if (has_seed) {
+        generator.seed(seed);
+    }
+    generator.setRng(rng_kind);
+
+    // Load blocklist if specified
+    if (!exclude_path.empty()) {
+        try {
+            generator.loadExclusions(exclude_path);
+        } catch (const std::exception& e) {
+            std::cerr << "Error loading exclusion list: " << e.what() << '\n';
+            return 1;
+        }
+    }
+
+    if (!blend_spec.empty() && !profile_path.empty()) {
+        std::cerr << "Error: --blend replaces --profile; use one of them\n";
+        return 1;
+    }
 
     // Load profile if specified
-    if (!profile_path.empty()) {
+    if (!profile_path.empty() || !blend_spec.empty()) {
         try {
-            generator.loadProfile(profile_path);
+            if (blend_spec.empty()) {
+                generator.loadProfile(profile_path);
+            } else {
+                std::vector<ProfileData::BlendComponent> components;
+                for (const auto& [path, weight] : ProfileData::parseBlendSpec(blend_spec)) {
+                    components.push_back({std::make_shared<const ProfileData>(path), weight});
+                }
+                generator.setProfile(ProfileData::blend(components));
+            }
             generator.setStrategy(strategy);
             generator.setMinLength(min_length);
             generator.setMaxLength(max_length);
@@ -154,24 +885,60 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    // Generate names
-    if (debug) {
-        // Generate with pattern/strategy information
-        auto results = generator.generateWithPattern(count);
+    // Stream names straight to the output; memory use doesn't depend on count
+    try {
+        std::unique_ptr<OutputWriter> out = output_path.empty() ?
+            std::make_unique<OutputWriter>(1) : std::make_unique<OutputWriter>(output_path);
 
-        // Print names with patterns/strategies
-        for (const auto& result : results) {
-            std::cout << result.name << " [" << result.pattern << "]\n";
+        StreamOptions options;
+        options.threads = threads;
+        options.with_pattern = debug;
+        options.unique = unique;
+        options.bulk = bulk;
+        options.first_index = start_index;
+
+        if (name_count > 0) {
+            generator.generateStream(name_count, options, [&out](std::string_view text) {
+                out->write(text);
+            });
         }
-    } else {
-        // Generate names only
-        auto names = generator.generate(count);
+        out->flush();
 
-        // Print all generated names
-        for (const auto& name : names) {
-            std::cout << name << '\n';
+        if (!manifest_path.empty()) {
+            ShardManifest manifest;
+            manifest.seed = seed;
+            manifest.rng = Rng::kindName(rng_kind);
+            manifest.profile = blend_spec.empty() ? profile_path : blend_spec;
+            if (blend_spec.empty()) {
+                manifest.profile_hash = profile_path.empty() ? "" : ShardManifest::hashFile(profile_path);
+            } else {
+                for (const auto& [path, weight] : ProfileData::parseBlendSpec(blend_spec)) {
+                    manifest.profile_hash += (manifest.profile_hash.empty() ? "" : ",") +
+                                             ShardManifest::hashFile(path) + ":" + std::to_string(weight);
+                }
+            }
+            manifest.profile2 = profile2_path;
+            manifest.profile2_hash = profile2_path.empty() ? "" : ShardManifest::hashFile(profile2_path);
+            manifest.exclude = exclude_path;
+            manifest.exclude_hash = exclude_path.empty() ? "" : ShardManifest::hashFile(exclude_path);
+            manifest.strategy = NameGenerator::strategyName(strategy);
+            manifest.min_length = min_length;
+            manifest.max_length = max_length;
+            manifest.total_count = count;
+            manifest.shard = shard;
+            manifest.shards = shards;
+            manifest.first_index = start_index;
+            manifest.count = name_count;
+            manifest.output = output_path;
+            manifest.save(manifest_path);
         }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
     }
 
+    if (stats) {
+        std::cerr << Stats::toJson() << '\n';
+    }
     return 0;
 }